@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+#
+# File: memory_report.py
+#
+# Author: Tyler Reckart (tyler.reckart@gmail.com)
+# Copyright 2024
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+# See http://creativecommons.org/licenses/MIT/ for more information.
+
+"""Static IRAM/DRAM/flash usage of a firmware build, per subsystem.
+
+Reads the GNU ld map file the ESP32 Arduino build leaves next to the ELF (arduino-cli writes
+<sketch>.ino.map into its build path, PlatformIO writes firmware.map with -Wl,-Map) and sums every
+input section by the object it came from. Objects built from src/ fold into the subsystems below,
+everything else into the library or archive it was linked from.
+
+    memory_report.py firmware.map                  subsystem totals and region usage
+    memory_report.py firmware.map --modules        every object on its own line
+    memory_report.py firmware.map --fail-above 95  exit 1 once IRAM or DRAM passes 95 percent
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# Source files of src/ by subsystem; the real-time path is the engine plus output
+SUBSYSTEMS = {
+    'synth': 'engine', 'params': 'engine', 'events': 'engine', 'pitch': 'engine', 'tables': 'engine',
+    'wavetable': 'engine', 'tuning': 'engine', 'scales': 'engine',
+    'audio': 'output', 'dac': 'output', 'cv': 'output', 'capture': 'output',
+    'ui': 'ui', 'display': 'ui', 'analyzer': 'ui', 'oled': 'ui', 'input': 'ui', 'presets': 'ui', 'control': 'ui',
+    'governor': 'ui', 'bitmap': 'ui', 'main': 'ui',
+    'profile': 'profile',
+}
+
+# Output sections of the ESP32 linker script by the memory they occupy at run time
+REGIONS = [
+    ('IRAM', ('.iram0.vectors', '.iram0.text', '.iram0.data', '.iram0.bss')),
+    ('DRAM', ('.dram0.data', '.dram0.bss', '.noinit')),
+    ('flash code', ('.flash.text',)),
+    ('flash data', ('.flash.rodata', '.flash.appdesc')),
+]
+
+# Memory segment each region is placed in, for the usage against its size
+SEGMENTS = {'IRAM': 'iram0_0_seg', 'DRAM': 'dram0_0_seg', 'flash code': 'iram0_2_seg', 'flash data': 'drom0_0_seg'}
+
+SEGMENT_LINE = re.compile(r'^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+OUTPUT_SECTION = re.compile(r'^(\.\S+)(?:\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+)?')
+INPUT_SECTION = re.compile(r'^ (\.\S+|COMMON)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*))?$')
+WRAPPED_INPUT = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+
+
+def region_of(output_section):
+    for region, sections in REGIONS:
+        if output_section in sections:
+            return region
+    return None
+
+
+def module_of(path):
+    """Short name of the object an input section came from, and the subsystem it belongs to."""
+    archive = re.match(r'(.*)\((.*)\)$', path)
+    if archive:
+        library = os.path.basename(archive.group(1))
+        library = re.sub(r'^lib', '', re.sub(r'\.a$', '', library))
+        return re.sub(r'\.(cpp|c|S)?\.?o(bj)?$', '', archive.group(2)), library
+
+    name = os.path.basename(path)
+    source = re.sub(r'\.(cpp|c|S)?\.?o(bj)?$', '', name)
+    if source in SUBSYSTEMS:
+        return source, SUBSYSTEMS[source]
+
+    # Sketch libraries compiled to loose objects sit under a directory named after the library
+    parts = path.replace('\\', '/').split('/')
+    if 'libraries' in parts and parts.index('libraries') + 1 < len(parts):
+        return source, parts[parts.index('libraries') + 1]
+    return source, 'other'
+
+
+def parse_map(lines):
+    segments = {}
+    usage = {}  # (subsystem, module) -> {region: bytes}
+    in_memory_map = False
+    output_section = None
+    pending = None  # Input section whose address and size wrapped onto the next line
+
+    for line in lines:
+        line = line.rstrip('\n')
+
+        if not in_memory_map:
+            match = SEGMENT_LINE.match(line)
+            if match:
+                segments[match.group(1)] = int(match.group(3), 16)
+            if line.startswith('Linker script and memory map'):
+                in_memory_map = True
+            continue
+
+        if pending is not None:
+            match = WRAPPED_INPUT.match(line)
+            pending = None
+            if match:
+                add_section(usage, output_section, int(match.group(2), 16), match.group(3))
+                continue
+
+        if line.startswith('.'):
+            match = OUTPUT_SECTION.match(line)
+            output_section = match.group(1) if match else None
+            continue
+
+        match = INPUT_SECTION.match(line)
+        if match:
+            if match.group(2) is None:
+                pending = match.group(1)
+            else:
+                add_section(usage, output_section, int(match.group(3), 16), match.group(4))
+
+    return segments, usage
+
+
+def add_section(usage, output_section, size, path):
+    region = region_of(output_section)
+    if region is None or size == 0:
+        return
+    module, subsystem = module_of(path.strip())
+    totals = usage.setdefault((subsystem, module), {})
+    totals[region] = totals.get(region, 0) + size
+
+
+def print_rows(rows):
+    for name, totals in rows:
+        print('%-36s' % name[:36] + ''.join('%12d' % totals.get(region, 0) for region, _ in REGIONS))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Static memory usage of a firmware build, per subsystem')
+    parser.add_argument('map', help='linker map file of the firmware build')
+    parser.add_argument('--modules', action='store_true', help='list every object instead of subsystem totals')
+    parser.add_argument('--fail-above', type=float, metavar='PERCENT',
+                        help='exit with status 1 when IRAM or DRAM usage passes this share of its segment')
+    args = parser.parse_args()
+
+    with open(args.map) as f:
+        segments, usage = parse_map(f)
+    if not usage:
+        sys.exit('%s: no IRAM, DRAM or flash sections found, is this an ESP32 linker map?' % args.map)
+
+    grouped = {}
+    for (subsystem, module), totals in usage.items():
+        key = '%s/%s' % (subsystem, module) if args.modules else subsystem
+        row = grouped.setdefault(key, {})
+        for region, size in totals.items():
+            row[region] = row.get(region, 0) + size
+
+    # The firmware's own subsystems first, then the libraries by how much IRAM and DRAM they take
+    own = set(SUBSYSTEMS.values())
+    rows = sorted(grouped.items(), key=lambda row: (row[0].split('/')[0] not in own,
+                                                     -(row[1].get('IRAM', 0) + row[1].get('DRAM', 0)), row[0]))
+    print('%-36s' % ('module' if args.modules else 'subsystem') + ''.join('%12s' % region for region, _ in REGIONS))
+    print_rows(rows)
+
+    totals = {}
+    for _, row in grouped.items():
+        for region, size in row.items():
+            totals[region] = totals.get(region, 0) + size
+    print_rows([('total', totals)])
+
+    # DRAM counts static data only, the heap and task stacks take what is left of the segment
+    print('')
+    over = False
+    for region, _ in REGIONS:
+        used = totals.get(region, 0)
+        size = segments.get(SEGMENTS[region])
+        if not size:
+            print('%-12s %8d bytes' % (region, used))
+            continue
+        percent = 100.0 * used / size
+        print('%-12s %8d of %8d bytes, %5.1f%% (%s)' % (region, used, size, percent, SEGMENTS[region]))
+        if args.fail_above is not None and region in ('IRAM', 'DRAM') and percent > args.fail_above:
+            over = True
+
+    if over:
+        print('%s: IRAM or DRAM usage is past %g%%' % (args.map, args.fail_above), file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,410 @@
+/*
+ * File: render.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#include "render.h"
+#include "events.h"
+#include "params.h"
+#include "tuning.h"
+#include <algorithm>
+#include <ctype.h>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+
+static const char *const waveformKeywords[] = {"sine", "saw", "triangle", "pulse"};
+static const char *const cvModeKeywords[] = {"none", "linfm", "expfm", "amplitude", "pitch"};
+
+static int findKeyword(const std::string &word, const char *const keywords[], int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (word == keywords[i])
+            return i;
+    }
+    return -1;
+}
+
+// Scale names as script words: "Natural Harmonic" is natural-harmonic
+static int findScale(const std::string &word)
+{
+    for (int i = 0; i < scaleCount; ++i)
+    {
+        std::string keyword = scales[i].name;
+        for (size_t c = 0; c < keyword.size(); ++c)
+        {
+            keyword[c] = keyword[c] == ' ' ? '-' : (char)tolower((unsigned char)keyword[c]);
+        }
+        if (word == keyword)
+            return i;
+    }
+    return -1;
+}
+
+static bool eventBefore(const RenderEvent &a, const RenderEvent &b)
+{
+    return a.time < b.time;
+}
+
+bool parseRenderScript(const std::string &text, RenderScript &script, std::string &error)
+{
+    std::istringstream input(text);
+    std::string line;
+    int lineNumber = 0;
+    bool ended = false;
+
+    script.events.clear();
+    script.duration = 0.0;
+
+    while (std::getline(input, line))
+    {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream fields(line);
+        RenderEvent event = {};
+        std::string command;
+        if (!(fields >> event.time))
+        {
+            if (fields.eof() && line.find_first_not_of(" \t\r") == std::string::npos)
+                continue; // Blank or comment
+            error = "line " + std::to_string(lineNumber) + ": expected a time";
+            return false;
+        }
+
+        bool ok = (bool)(fields >> command) && event.time >= 0.0;
+        if (ok && command == "event")
+        {
+            event.queued = true;
+            ok = (bool)(fields >> command) && (command == "frequency" || command == "amplitude" || command == "matrix");
+        }
+        std::string word;
+        if (ok && command == "frequency")
+        {
+            event.command = RENDER_FREQUENCY;
+            ok = (bool)(fields >> event.value);
+        }
+        else if (ok && command == "waveform")
+        {
+            event.command = RENDER_WAVEFORM;
+            ok = (bool)(fields >> word);
+            event.value = (float)findKeyword(word, waveformKeywords, 4);
+            ok = ok && event.value >= 0.0f;
+        }
+        else if (ok && command == "scale")
+        {
+            event.command = RENDER_SCALE;
+            ok = (bool)(fields >> word);
+            event.value = (float)findScale(word);
+            ok = ok && event.value >= 0.0f;
+        }
+        else if (ok && (command == "amplitude" || command == "pan"))
+        {
+            event.command = command == "pan" ? RENDER_PAN : RENDER_AMPLITUDE;
+            ok = (bool)(fields >> event.index >> event.value) && event.index >= 1 && event.index <= numPartials;
+        }
+        else if (ok && command == "matrix")
+        {
+            event.command = RENDER_MATRIX;
+            ok = (bool)(fields >> event.index >> event.target >> event.value) &&
+                 event.index >= 1 && event.index <= numPartials && event.target >= 1 && event.target <= numPartials;
+            event.target -= 1;
+        }
+        else if (ok && command == "cvmode")
+        {
+            event.command = RENDER_CV_MODE;
+            ok = (bool)(fields >> event.index >> word) && event.index >= 1 && event.index <= 4;
+            event.value = (float)findKeyword(word, cvModeKeywords, 5);
+            ok = ok && event.value >= 0.0f;
+        }
+        else if (ok && command == "morph")
+        {
+            event.command = RENDER_MORPH;
+            ok = (bool)(fields >> event.seconds) && event.seconds >= 0.0;
+        }
+        else if (ok && command == "cv")
+        {
+            event.command = RENDER_CV;
+            ok = (bool)(fields >> event.index >> event.value) && event.index >= 1 && event.index <= 4;
+        }
+        else if (ok && command == "cvramp")
+        {
+            event.command = RENDER_CV_RAMP;
+            ok = (bool)(fields >> event.index >> event.value >> event.seconds) &&
+                 event.index >= 1 && event.index <= 4 && event.seconds >= 0.0;
+        }
+        else if (ok && command == "end")
+        {
+            event.command = RENDER_END;
+            ended = true;
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            error = "line " + std::to_string(lineNumber) + ": cannot read \"" + line + "\"";
+            return false;
+        }
+
+        event.index -= 1;
+        script.events.push_back(event);
+        if (ended)
+        {
+            script.duration = event.time;
+            break;
+        }
+    }
+
+    std::stable_sort(script.events.begin(), script.events.end(), eventBefore);
+    if (!ended)
+    {
+        script.duration = (script.events.empty() ? 0.0 : script.events.back().time) + 1.0;
+    }
+    return true;
+}
+
+static inline float toFloat(sample_t sample)
+{
+#if SYNTH_FIXED_POINT
+    return (float)sample * (1.0f / 32768.0f);
+#else
+    return sample;
+#endif
+}
+
+// The commands a script can send as control events, see parseRenderScript()
+static uint8_t controlEventType(RenderCommand command)
+{
+    switch (command)
+    {
+    case RENDER_FREQUENCY:
+        return EVENT_FREQUENCY;
+    case RENDER_AMPLITUDE:
+        return EVENT_AMPLITUDE;
+    default:
+        return EVENT_MATRIX;
+    }
+}
+
+// A CV input moving linearly toward a target, or holding once it gets there
+struct CvCurve
+{
+    float value;
+    float target;
+    float step; // Per block
+};
+
+void renderScript(const RenderScript &script, std::vector<float> &frames)
+{
+    static SynthParams params; // Sized by the partial count, kept off the stack
+    params = SynthParams();
+    params.harmonicAmplitudes[0] = 1.0f;
+    for (int i = 0; i < numPartials; ++i)
+    {
+        params.harmonicPanning[i] = 0.5f;
+    }
+    params.baseFrequency = 440.0f;
+    params.waveform = SINE;
+    for (int i = 0; i < 4; ++i)
+    {
+        params.cvAssignments[i] = NONE;
+    }
+
+    CvCurve curves[4] = {};
+    const double blockSeconds = (double)AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE;
+    long blocks = (long)(script.duration / blockSeconds + 0.5);
+    size_t next = 0;
+    size_t nextQueued = 0;
+    const uint32_t startFrame = renderedFrames();
+    AudioBlock block;
+
+    // Events an earlier render left applied are no part of this one
+    ControlEvent stale;
+    while (nextAppliedEvent(stale))
+    {
+    }
+    params.eventsTaken = appliedEventsTaken();
+
+    frames.assign((size_t)blocks * AUDIO_BLOCK_SIZE * RENDER_CHANNELS, 0.0f);
+    publishParams(params);
+
+    for (long b = 0; b < blocks; ++b)
+    {
+        // Apply everything due by the start of this block
+        double now = b * blockSeconds;
+        bool changed = false;
+        for (; next < script.events.size() && script.events[next].time <= now + 1e-9; ++next)
+        {
+            const RenderEvent &event = script.events[next];
+            if (event.queued)
+                continue;
+            switch (event.command)
+            {
+            case RENDER_FREQUENCY:
+                params.baseFrequency = event.value;
+                break;
+            case RENDER_WAVEFORM:
+                params.waveform = (WaveformType)(int)event.value;
+                break;
+            case RENDER_SCALE:
+                params.scale = (int)event.value;
+                break;
+            case RENDER_AMPLITUDE:
+                params.harmonicAmplitudes[event.index] = event.value;
+                break;
+            case RENDER_PAN:
+                params.harmonicPanning[event.index] = event.value;
+                break;
+            case RENDER_MATRIX:
+                params.modulationMatrix[event.index][event.target] = event.value;
+                break;
+            case RENDER_CV_MODE:
+                params.cvAssignments[event.index] = (CVMode)(int)event.value;
+                break;
+            case RENDER_MORPH:
+                params.morphSeconds = (float)event.seconds;
+                break;
+            case RENDER_CV:
+                curves[event.index].value = curves[event.index].target = event.value;
+                curves[event.index].step = 0.0f;
+                break;
+            case RENDER_CV_RAMP:
+            {
+                CvCurve &curve = curves[event.index];
+                double rampBlocks = event.seconds / blockSeconds;
+                curve.target = event.value;
+                curve.step = rampBlocks < 1.0 ? curve.target - curve.value : (float)((curve.target - curve.value) / rampBlocks);
+                break;
+            }
+            case RENDER_END:
+                break;
+            }
+            changed = changed || event.command < RENDER_CV;
+        }
+        if (changed)
+        {
+            publishParams(params);
+            params.morphSeconds = 0.0f; // A morph covers the changes published with it only
+        }
+
+        float cvValues[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            CvCurve &curve = curves[i];
+            cvValues[i] = curve.value;
+            float remaining = curve.target - curve.value;
+            curve.value = (curve.step > 0.0f ? remaining < curve.step : remaining > curve.step) ? curve.target : curve.value + curve.step;
+        }
+
+        // Control events falling in this block go to the engine stamped with their frame
+        for (; nextQueued < script.events.size() && script.events[nextQueued].time < now + blockSeconds - 1e-9; ++nextQueued)
+        {
+            const RenderEvent &event = script.events[nextQueued];
+            if (!event.queued)
+                continue;
+            ControlEvent control = {startFrame + (uint32_t)(event.time * AUDIO_SAMPLE_RATE + 0.5), controlEventType(event.command),
+                                    (uint8_t)(event.index < 0 ? 0 : event.index), (uint8_t)event.target, event.value};
+            postEvent(control);
+        }
+
+        renderBlock(block, AUDIO_BLOCK_SIZE, cvValues);
+
+        // Take in the control events the engine applied, as the UI does on the device
+        ControlEvent applied;
+        while (nextAppliedEvent(applied))
+        {
+            if (applied.type == EVENT_FREQUENCY)
+                params.baseFrequency = applied.value;
+            else if (applied.type == EVENT_AMPLITUDE)
+                params.harmonicAmplitudes[applied.source] = applied.value;
+            else
+                params.modulationMatrix[applied.source][applied.target] = applied.value;
+        }
+        params.eventsTaken = appliedEventsTaken();
+
+        float *out = &frames[(size_t)b * AUDIO_BLOCK_SIZE * RENDER_CHANNELS];
+        for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n, out += RENDER_CHANNELS)
+        {
+            out[RENDER_LEFT] = toFloat(block.left[n]);
+            out[RENDER_RIGHT] = toFloat(block.right[n]);
+            out[RENDER_STEREO] = toFloat(block.stereo[n]);
+            for (int i = 0; i < numWaveOutputs; ++i)
+            {
+                out[RENDER_WAVE + i] = toFloat(block.wave[i][n]);
+            }
+        }
+    }
+}
+
+static void putLittleEndian(FILE *file, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        fputc((int)((value >> (8 * i)) & 0xFF), file);
+    }
+}
+
+bool writeWav(const char *path, const std::vector<float> &frames, int channels, int sampleRate)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    // WAVE_FORMAT_EXTENSIBLE, as more than two channels require, with IEEE float samples
+    static const uint8_t floatSubformat[16] = {0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                                               0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+    uint32_t dataBytes = (uint32_t)(frames.size() * sizeof(float));
+
+    fwrite("RIFF", 1, 4, file);
+    putLittleEndian(file, 4 + (8 + 40) + (8 + dataBytes), 4);
+    fwrite("WAVEfmt ", 1, 8, file);
+    putLittleEndian(file, 40, 4);
+    putLittleEndian(file, 0xFFFE, 2);
+    putLittleEndian(file, channels, 2);
+    putLittleEndian(file, sampleRate, 4);
+    putLittleEndian(file, sampleRate * channels * 4, 4);
+    putLittleEndian(file, channels * 4, 2);
+    putLittleEndian(file, 32, 2);
+    putLittleEndian(file, 22, 2); // Extension size
+    putLittleEndian(file, 32, 2); // Valid bits
+    putLittleEndian(file, 0, 4);  // No speaker positions, the outputs are not a surround layout
+    fwrite(floatSubformat, 1, sizeof(floatSubformat), file);
+    fwrite("data", 1, 4, file);
+    putLittleEndian(file, dataBytes, 4);
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        uint32_t bits;
+        memcpy(&bits, &frames[i], sizeof(bits));
+        putLittleEndian(file, bits, 4);
+    }
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * File: render.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "synth.h"
+#include <string>
+#include <vector>
+
+// Offline renders drive the engine block by block from a script of timed settings changes. One
+// command per line, times in seconds, harmonics and CV inputs numbered from 1 as on the display:
+//
+//   # time  command    arguments
+//   0       frequency  220
+//   0       waveform   saw                    sine, saw, triangle or pulse
+//   0       scale      major                  scale name in lower case, spaces as dashes
+//   0       amplitude  3 0.5                  harmonic, amplitude
+//   0       pan        3 0.0                  harmonic, 0.0 left to 1.0 right
+//   0.5     matrix     1 2 10                 source harmonic, target harmonic, amount
+//   0       cvmode     1 pitch                CV input, none, linfm, expfm, amplitude or pitch
+//   0.5     morph      2.0                    seconds to morph to the settings changed at this time
+//   1.0     cv         1 0.25                 CV input, value
+//   1.0     cvramp     1 0.75 0.5             CV input, target, seconds to get there
+//   1.2513  event      amplitude 2 0.8        frequency, amplitude or matrix as a control event
+//   2.0     end
+//
+// A render starts from the power-on settings, H1 alone at 440 Hz, and stops at "end" or one second
+// past the last command. Settings change between blocks, as they do on the device, except control
+// events, which take effect on the frame nearest their time as MIDI and the serial protocol do.
+// Settings changed alongside a morph are published with its morphSeconds, as a preset morph is.
+
+// Output channels, in the order the MCP4725s are numbered
+#define RENDER_LEFT 0
+#define RENDER_RIGHT 1
+#define RENDER_STEREO 2
+#define RENDER_WAVE 3 // First of the individual wave outputs
+#define RENDER_CHANNELS (RENDER_WAVE + numWaveOutputs)
+
+enum RenderCommand
+{
+    RENDER_FREQUENCY,
+    RENDER_WAVEFORM,
+    RENDER_SCALE,
+    RENDER_AMPLITUDE,
+    RENDER_PAN,
+    RENDER_MATRIX,
+    RENDER_CV_MODE,
+    RENDER_MORPH,
+    RENDER_CV,
+    RENDER_CV_RAMP,
+    RENDER_END
+};
+
+struct RenderEvent
+{
+    double time;
+    RenderCommand command;
+    int index;   // Harmonic, source harmonic or CV input, from 0
+    int target;  // Target harmonic of a matrix entry
+    float value; // Value, or the enumerator of a waveform or CV mode, or a scale index
+    double seconds;
+    bool queued; // Through the control event queue, see events.h
+};
+
+struct RenderScript
+{
+    std::vector<RenderEvent> events; // Sorted by time
+    double duration;
+};
+
+// Returns false with a message naming the line when the script does not parse
+bool parseRenderScript(const std::string &text, RenderScript &script, std::string &error);
+
+// Render a script into interleaved frames of RENDER_CHANNELS samples at full scale +-1.0
+void renderScript(const RenderScript &script, std::vector<float> &frames);
+
+// 32-bit float WAV with one channel per output
+bool writeWav(const char *path, const std::vector<float> &frames, int channels, int sampleRate);
+
+#endif
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+#
+# File: scala_tables.py
+#
+# Author: Tyler Reckart (tyler.reckart@gmail.com)
+# Copyright 2024
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+# See http://creativecommons.org/licenses/MIT/ for more information.
+
+"""Compile Scala .scl files into the scale tables of src/scales.cpp.
+
+Each file becomes one entry of the scale menu, in the order given, after the built-in Harmonic
+entry that keeps the partials on the harmonic series. Pitches are read as the Scala format defines
+them: a value with a period is in cents, anything else a ratio or whole number. The last pitch is
+the period the scale repeats at. The engine reads degrees in octaves above the tonic, so they are
+converted here and the firmware never takes a logarithm.
+
+    scala_tables.py ../src/scales.cpp ../resources/scales/major.scl ...
+
+The host CMake target "scales" regenerates the committed file from resources/scales.
+"""
+
+import math
+import os
+import re
+import sys
+
+SCALE_MAX_DEGREES = 64  # Keep in step with tuning.h
+SCALE_NAME_LENGTH = 16  # What fits the scale line under the waveform view
+
+LICENSE = '''/*
+ * File: scales.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+'''
+
+
+def pitch_octaves(text, path):
+    """A Scala pitch in octaves above the tonic."""
+    value = text.split()[0]
+    if '.' in value:
+        return float(value) / 1200.0
+    match = re.match(r'^(\d+)(?:/(\d+))?$', value)
+    if not match:
+        sys.exit('%s: cannot read pitch "%s"' % (path, text))
+    ratio = float(match.group(1)) / float(match.group(2) or 1)
+    if ratio <= 0:
+        sys.exit('%s: pitch "%s" is not positive' % (path, text))
+    return math.log2(ratio)
+
+
+def read_scala(path):
+    with open(path) as f:
+        lines = [line.strip() for line in f if not line.startswith('!')]
+
+    if len(lines) < 2:
+        sys.exit('%s: missing description or note count' % path)
+    name = lines[0] or os.path.splitext(os.path.basename(path))[0]
+    if len(name) > SCALE_NAME_LENGTH:
+        sys.exit('%s: name "%s" is longer than %d characters' % (path, name, SCALE_NAME_LENGTH))
+
+    count = int(lines[1].split()[0])
+    pitches = [pitch_octaves(line, path) for line in lines[2:] if line]
+    if count < 1 or len(pitches) != count:
+        sys.exit('%s: expected %d pitches, found %d' % (path, count, len(pitches)))
+    if count > SCALE_MAX_DEGREES:
+        sys.exit('%s: %d degrees, the engine holds up to %d' % (path, count, SCALE_MAX_DEGREES))
+
+    # The tonic is implied, the last pitch closes the period
+    degrees = [0.0] + pitches[:-1]
+    period = pitches[-1]
+    if any(b <= a for a, b in zip(degrees, degrees[1:] + [period])):
+        sys.exit('%s: pitches must ascend and stay below the period' % path)
+    return name, degrees, period
+
+
+def literal(value):
+    text = '%.9g' % value
+    if '.' not in text and 'e' not in text:
+        text += '.0'
+    return text + 'f'
+
+
+def identifier(name):
+    words = re.findall(r'[A-Za-z0-9]+', name)
+    return words[0].lower() + ''.join(word.capitalize() for word in words[1:]) + 'Degrees'
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    output = sys.argv[1]
+    scales = [read_scala(path) for path in sys.argv[2:]]
+
+    out = [LICENSE]
+    out.append('// Generated by host/scala_tables.py from resources/scales, edit the .scl files and rerun it')
+    out.append('')
+    out.append('#include "tuning.h"')
+    out.append('#include "platform.h"')
+    out.append('')
+    out.append('// Degrees in octaves above the tonic, ascending from 0 and below the period. The engine copies')
+    out.append('// them on a scale change in the middle of rendering, so they sit in DRAM like its other tables.')
+    for name, degrees, period in scales:
+        values = ', '.join(literal(degree) for degree in degrees)
+        out.append('static const float %s[] DRAM_ATTR = {%s};' % (identifier(name), values))
+    out.append('')
+    out.append('const Scale scales[] DRAM_ATTR = {')
+    out.append('    {"Harmonic", 0, 1.0f, 0}, // Partials on the harmonic series, CV pitch unquantized')
+    for name, degrees, period in scales:
+        out.append('    {"%s", %d, %s, %s},' % (name, len(degrees), literal(period), identifier(name)))
+    out.append('};')
+    out.append('')
+    out.append('const int scaleCount DRAM_ATTR = sizeof(scales) / sizeof(scales[0]);')
+
+    with open(output, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
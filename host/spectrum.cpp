@@ -0,0 +1,145 @@
+/*
+ * File: spectrum.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#include "spectrum.h"
+#include <complex>
+#include <math.h>
+
+static const double pi = 3.14159265358979323846;
+
+// In-place iterative radix-2 FFT
+static void fft(std::vector<std::complex<double> > &data)
+{
+    const size_t n = data.size();
+
+    for (size_t i = 1, j = 0; i < n; ++i)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (size_t length = 2; length <= n; length <<= 1)
+    {
+        std::complex<double> unit = std::polar(1.0, -2.0 * pi / (double)length);
+        for (size_t i = 0; i < n; i += length)
+        {
+            std::complex<double> twiddle(1.0, 0.0);
+            for (size_t k = 0; k < length / 2; ++k)
+            {
+                std::complex<double> even = data[i + k];
+                std::complex<double> odd = data[i + k + length / 2] * twiddle;
+                data[i + k] = even + odd;
+                data[i + k + length / 2] = even - odd;
+                twiddle *= unit;
+            }
+        }
+    }
+}
+
+void analyzeSpectrum(const std::vector<float> &frames, int channels, int channel, long start, int size,
+                     double sampleRate, Spectrum &spectrum)
+{
+    std::vector<std::complex<double> > data(size);
+    for (int n = 0; n < size; ++n)
+    {
+        double phase = 2.0 * pi * n / size;
+        double window = 0.35875 - 0.48829 * cos(phase) + 0.14128 * cos(2.0 * phase) - 0.01168 * cos(3.0 * phase);
+        data[n] = frames[(size_t)(start + n) * channels + channel] * window;
+    }
+
+    fft(data);
+
+    spectrum.power.resize(size / 2 + 1);
+    for (int k = 0; k <= size / 2; ++k)
+    {
+        spectrum.power[k] = std::norm(data[k]);
+    }
+    spectrum.binHz = sampleRate / size;
+}
+
+double peakFrequency(const Spectrum &spectrum, double nearHz, double searchHz)
+{
+    const int last = (int)spectrum.power.size() - 2;
+    int low = (int)((nearHz - searchHz) / spectrum.binHz);
+    int high = (int)((nearHz + searchHz) / spectrum.binHz) + 1;
+    low = low < 1 ? 1 : low;
+    high = high > last ? last : high;
+
+    int peak = low;
+    for (int k = low; k <= high; ++k)
+    {
+        if (spectrum.power[k] > spectrum.power[peak])
+            peak = k;
+    }
+
+    double a = log(spectrum.power[peak - 1] + 1e-300);
+    double b = log(spectrum.power[peak] + 1e-300);
+    double c = log(spectrum.power[peak + 1] + 1e-300);
+    double offset = 0.5 * (a - c) / (a - 2.0 * b + c);
+    return (peak + offset) * spectrum.binHz;
+}
+
+double spurLevel(const Spectrum &spectrum, double fundamentalHz)
+{
+    const int guard = SPECTRUM_MAIN_LOBE_BINS + 2;
+    const int bins = (int)spectrum.power.size();
+    double harmonicPeak = 0.0;
+    double spurPeak = 1e-300;
+
+    for (int k = 0; k < bins; ++k)
+    {
+        double hz = k * spectrum.binHz;
+        double nearest = floor(hz / fundamentalHz + 0.5) * fundamentalHz;
+        bool onHarmonic = fabs(hz - nearest) <= guard * spectrum.binHz;
+        bool nearDc = k <= guard;
+
+        if (onHarmonic && !nearDc)
+        {
+            if (spectrum.power[k] > harmonicPeak)
+                harmonicPeak = spectrum.power[k];
+        }
+        else if (!onHarmonic && !nearDc)
+        {
+            if (spectrum.power[k] > spurPeak)
+                spurPeak = spectrum.power[k];
+        }
+    }
+
+    return 10.0 * log10(spurPeak / harmonicPeak);
+}
+
+double centsBetween(double measuredHz, double expectedHz)
+{
+    return 1200.0 * log2(measuredHz / expectedHz);
+}
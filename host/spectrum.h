@@ -0,0 +1,57 @@
+/*
+ * File: spectrum.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <vector>
+
+// Power spectrum of one channel through a 4-term Blackman-Harris window, whose sidelobes sit near
+// -92 dB, so spurs well below the quantization floor of the 12-bit outputs still show
+#define SPECTRUM_MAIN_LOBE_BINS 4 // Half width of the window's main lobe
+
+struct Spectrum
+{
+    std::vector<double> power; // Bins 0 to size / 2
+    double binHz;
+};
+
+// size must be a power of two; reads size frames of one channel from interleaved frames, from frame start
+void analyzeSpectrum(const std::vector<float> &frames, int channels, int channel, long start, int size,
+                     double sampleRate, Spectrum &spectrum);
+
+// Frequency of the strongest bin within searchHz of nearHz, refined by a parabola through the log power
+double peakFrequency(const Spectrum &spectrum, double nearHz, double searchHz);
+
+// Strongest bin outside the main lobes of DC and every multiple of fundamentalHz, in dB relative to
+// the strongest harmonic
+double spurLevel(const Spectrum &spectrum, double fundamentalHz);
+
+double centsBetween(double measuredHz, double expectedHz);
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * File: synth_bench.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+// Times renderBlock() on the host for every waveform, a few counts of sounding partials and a few CV
+// setups. Each case reports the best of several runs, the most repeatable figure for spotting
+// regressions, as nanoseconds per frame and counter ticks per block.
+//
+//   synth_bench [blocks per run]
+
+#include "synth.h"
+#include "params.h"
+#include "pitch.h"
+#include "wavetable.h"
+#include "platform.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_WARMUP_BLOCKS 64
+#define BENCH_RUNS 5
+
+static const char *const waveformLabels[] = {"sine", "saw", "triangle", "pulse"};
+
+// CV setups, from the cheapest control stage to every input and the modulation matrix in use
+enum BenchCv
+{
+    BENCH_CV_NONE,
+    BENCH_CV_PITCH,
+    BENCH_CV_ALL,
+    BENCH_CV_COUNT
+};
+
+static const char *const cvLabels[] = {"none", "1v/oct", "all+matrix"};
+
+static SynthParams params;
+static AudioBlock block;
+static volatile float sink; // Keeps the rendered output observable
+
+static void setUp(WaveformType waveform, int soundingPartials, BenchCv cv)
+{
+    params = SynthParams();
+    params.baseFrequency = 110.0f; // Keeps all 32 harmonics below Nyquist, so none are culled
+    params.waveform = waveform;
+
+    for (int i = 0; i < numPartials; ++i)
+    {
+        params.harmonicAmplitudes[i] = i < soundingPartials ? 1.0f / (i + 1) : 0.0f;
+        params.harmonicPanning[i] = (float)i / (numPartials - 1);
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        params.cvAssignments[i] = NONE;
+    }
+    if (cv == BENCH_CV_PITCH)
+    {
+        params.cvAssignments[0] = PITCH_1V_OCT;
+    }
+    else if (cv == BENCH_CV_ALL)
+    {
+        params.cvAssignments[0] = PITCH_1V_OCT;
+        params.cvAssignments[1] = EXP_FM;
+        params.cvAssignments[2] = LIN_FM;
+        params.cvAssignments[3] = AMPLITUDE;
+        for (int i = 0; i + 1 < numPartials; ++i)
+        {
+            params.modulationMatrix[i][i + 1] = 2.0f; // Each partial pulls its neighbour by a few Hz
+        }
+    }
+
+    publishParams(params);
+}
+
+// Render blocks with the CVs sweeping slowly, as a patched module would see them
+static void renderBlocks(int blocks)
+{
+    float cvValues[4];
+    float accumulator = 0.0f;
+
+    for (int b = 0; b < blocks; ++b)
+    {
+        float sweep = (float)(b & 255) * (1.0f / 2560.0f);
+        cvValues[0] = sweep;
+        cvValues[1] = 0.1f - sweep;
+        cvValues[2] = sweep * 0.5f;
+        cvValues[3] = 1.0f - sweep;
+
+        renderBlock(block, AUDIO_BLOCK_SIZE, cvValues);
+        accumulator += (float)block.stereo[AUDIO_BLOCK_SIZE - 1];
+    }
+    sink = accumulator;
+}
+
+int main(int argc, char **argv)
+{
+    int blocks = argc > 1 ? atoi(argv[1]) : 2000;
+    if (blocks <= 0)
+    {
+        fprintf(stderr, "usage: %s [blocks per run]\n", argv[0]);
+        return 1;
+    }
+
+    initWavetables();
+    initPitch();
+
+    printf("%d partials, %s, %d frames per block at %d Hz, %d blocks per run\n", numPartials,
+           SYNTH_FIXED_POINT ? "fixed point" : "float", AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE, blocks);
+    printf("%-9s %8s %-11s %10s %12s %8s\n", "waveform", "partials", "cv", "ns/frame", "ticks/block", "load %");
+
+    const int soundingCounts[] = {1, numWaveOutputs, numPartials};
+
+    for (int waveform = SINE; waveform <= PULSE; ++waveform)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            if (c > 0 && soundingCounts[c] == soundingCounts[c - 1])
+                continue;
+
+            for (int cv = 0; cv < BENCH_CV_COUNT; ++cv)
+            {
+                setUp((WaveformType)waveform, soundingCounts[c], (BenchCv)cv);
+                renderBlocks(BENCH_WARMUP_BLOCKS); // Let the ramps and glides settle
+
+                double bestSeconds = 1e30;
+                uint32_t bestTicks = UINT32_MAX;
+                for (int run = 0; run < BENCH_RUNS; ++run)
+                {
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    uint32_t startTicks = platformCycleCount();
+                    renderBlocks(blocks);
+                    uint32_t ticks = platformCycleCount() - startTicks;
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                    if (seconds < bestSeconds)
+                        bestSeconds = seconds;
+                    if (ticks < bestTicks)
+                        bestTicks = ticks;
+                }
+
+                double frames = (double)blocks * AUDIO_BLOCK_SIZE;
+                double nsPerFrame = bestSeconds * 1e9 / frames;
+                double load = nsPerFrame * AUDIO_SAMPLE_RATE * 1e-7; // Share of real time on this host
+                printf("%-9s %8d %-11s %10.1f %12u %8.2f\n", waveformLabels[waveform], soundingCounts[c], cvLabels[cv],
+                       nsPerFrame, bestTicks / (uint32_t)blocks, load);
+            }
+        }
+    }
+
+    return 0;
+}
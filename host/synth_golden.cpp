@@ -0,0 +1,500 @@
+/*
+ * File: synth_golden.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+// Spectral and time-domain checks on offline renders, the measurements a scope and analyzer on the
+// bench would otherwise make whenever an approximation in the engine changes: pitch accuracy of the
+// partials and CV paths, the aliasing floor of every waveform and the continuity of the phase
+// across control blocks, glides and settings changes, and the straight path of a preset morph.
+// Exits non-zero when any check fails.
+
+#include "render.h"
+#include "analyzer.h"
+#include "capture.h"
+#include "events.h"
+#include "spectrum.h"
+#include "pitch.h"
+#include "wavetable.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+#define GOLDEN_FFT_SIZE 65536   // 1.4 s at 48 kHz, bins a little under 0.75 Hz wide
+#define GOLDEN_SETTLE_SECONDS 0.25
+
+// Pitch error allowed on any partial, far tighter than a tuner can show
+#define GOLDEN_MAX_CENTS 0.1
+
+// Strongest spur allowed next to the strongest harmonic. The 12-bit outputs bottom out near -74 dB,
+// and the images of linear interpolation on the 1024-point wavetables sit just under that at low
+// pitches. Sine partials have no table, so seams in them show far lower.
+#define GOLDEN_MAX_ALIAS_DB -72.0
+#define GOLDEN_MAX_SEAM_DB -88.0
+
+// Distance a morph may stray from a straight line, as a share of the distance it covers. A control
+// block of lag and the chirp inside each measurement add up to a fraction of this.
+#define GOLDEN_MAX_GLIDE_ERROR 0.01
+
+static int failures = 0;
+
+static void check(const char *name, bool pass, const char *detail)
+{
+    printf("%s  %-40s %s\n", pass ? "pass" : "FAIL", name, detail);
+    if (!pass)
+        failures++;
+}
+
+static bool render(const char *text, std::vector<float> &frames)
+{
+    RenderScript script;
+    std::string error;
+    if (!parseRenderScript(text, script, error))
+    {
+        check("script", false, error.c_str());
+        return false;
+    }
+    renderScript(script, frames);
+    return true;
+}
+
+static void analyzeChannel(const std::vector<float> &frames, int channel, Spectrum &spectrum)
+{
+    long start = (long)(GOLDEN_SETTLE_SECONDS * AUDIO_SAMPLE_RATE);
+    analyzeSpectrum(frames, RENDER_CHANNELS, channel, start, GOLDEN_FFT_SIZE, AUDIO_SAMPLE_RATE, spectrum);
+}
+
+static void checkPitch(const char *name, const std::vector<float> &frames, int channel, double expectedHz)
+{
+    Spectrum spectrum;
+    analyzeChannel(frames, channel, spectrum);
+    double measured = peakFrequency(spectrum, expectedHz, 20.0);
+    double cents = centsBetween(measured, expectedHz);
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "%.3f Hz for %.3f Hz, %+.4f cents", measured, expectedHz, cents);
+    check(name, fabs(cents) <= GOLDEN_MAX_CENTS, detail);
+}
+
+static void checkSpurs(const char *name, const std::vector<float> &frames, int channel, double fundamentalHz, double limitDb)
+{
+    Spectrum spectrum;
+    analyzeChannel(frames, channel, spectrum);
+    double level = spurLevel(spectrum, fundamentalHz);
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "worst spur %.1f dB", level);
+    check(name, level <= limitDb, detail);
+}
+
+// Every partial and the CV pitch paths, measured on the outputs that carry them alone
+static void testPitch()
+{
+    std::vector<float> frames;
+    if (render("0 amplitude 2 0.5\n0 amplitude 3 0.33\n0 amplitude 4 0.25\n0 amplitude 5 0.2\n"
+               "0 amplitude 6 0.17\n0 amplitude 7 0.14\n2 end\n", frames))
+    {
+        for (int i = 0; i < numWaveOutputs; ++i)
+        {
+            char name[48];
+            snprintf(name, sizeof(name), "pitch of H%d at 440 Hz", i + 1);
+            checkPitch(name, frames, RENDER_WAVE + i, 440.0 * (i + 1));
+        }
+    }
+
+    // Uncalibrated inputs map the CV range onto the octave below the base frequency
+    if (render("0 cvmode 1 pitch\n0 cv 1 0.5\n2 end\n", frames))
+        checkPitch("1V/oct CV at half scale", frames, RENDER_WAVE, 440.0 * pow(2.0, -0.5));
+    if (render("0 cvmode 1 pitch\n0 cv 1 0.875\n2 end\n", frames))
+        checkPitch("1V/oct CV at seven eighths", frames, RENDER_WAVE, 440.0 * pow(2.0, -0.125));
+    if (render("0 cvmode 2 expfm\n0 cv 2 0.3\n2 end\n", frames))
+        checkPitch("exponential FM CV", frames, RENDER_WAVE, 440.0 * pow(2.0, 0.3));
+    if (render("0 cvmode 3 linfm\n0 cv 3 0.25\n2 end\n", frames))
+        checkPitch("linear FM CV", frames, RENDER_WAVE, 440.0 * 1.25);
+}
+
+// Partials on the degrees of a scale, and 1V/oct CV snapped to the nearest degree, across periods of
+// an octave and of a tritave
+static void testTuning()
+{
+    static const double majorSemitones[] = {0, 2, 4, 5, 7, 9, 11};
+    std::vector<float> frames;
+    if (render("0 scale major\n0 amplitude 2 0.5\n0 amplitude 3 0.33\n0 amplitude 4 0.25\n0 amplitude 5 0.2\n"
+               "0 amplitude 6 0.17\n0 amplitude 7 0.14\n2 end\n", frames))
+    {
+        for (int i = 0; i < numWaveOutputs; ++i)
+        {
+            char name[48];
+            snprintf(name, sizeof(name), "pitch of H%d on the major scale", i + 1);
+            checkPitch(name, frames, RENDER_WAVE + i, 440.0 * pow(2.0, majorSemitones[i] / 12.0));
+        }
+    }
+
+    // 0.3 of the CV range is 0.7 octaves down, nearest the major third of the octave below
+    if (render("0 scale major\n0 cvmode 1 pitch\n0 cv 1 0.3\n2 end\n", frames))
+        checkPitch("1V/oct CV quantized to major", frames, RENDER_WAVE, 440.0 * pow(2.0, 4.0 / 12.0 - 1.0));
+
+    // The same, nearest the seventh of thirteen steps in the tritave below
+    if (render("0 scale bohlen-pierce\n0 cvmode 1 pitch\n0 cv 1 0.3\n2 end\n", frames))
+        checkPitch("1V/oct CV quantized to Bohlen-Pierce", frames, RENDER_WAVE, 440.0 * pow(3.0, 7.0 / 13.0 - 1.0));
+}
+
+// Band-limited shapes up to the top octaves, and a full spread of sine partials partly past Nyquist
+static void testAliasing()
+{
+    static const char *const shapes[] = {"saw", "triangle", "pulse"};
+    static const float frequencies[] = {110.0f, 1760.0f, 5000.0f};
+    std::vector<float> frames;
+
+    for (int s = 0; s < 3; ++s)
+    {
+        for (int f = 0; f < 3; ++f)
+        {
+            char text[96];
+            snprintf(text, sizeof(text), "0 waveform %s\n0 frequency %.1f\n2 end\n", shapes[s], frequencies[f]);
+            char name[48];
+            snprintf(name, sizeof(name), "aliasing of %s at %.0f Hz", shapes[s], frequencies[f]);
+            if (render(text, frames))
+                checkSpurs(name, frames, RENDER_WAVE, frequencies[f], GOLDEN_MAX_ALIAS_DB);
+        }
+    }
+
+    std::string text = "0 frequency 1000\n";
+    for (int i = 2; i <= numPartials; ++i)
+    {
+        char line[48];
+        snprintf(line, sizeof(line), "0 amplitude %d %.4f\n", i, 1.0 / i);
+        text += line;
+    }
+    text += "2 end\n";
+    if (render(text.c_str(), frames))
+        checkSpurs("aliasing of all sine partials at 1 kHz", frames, RENDER_STEREO, 1000.0, GOLDEN_MAX_SEAM_DB);
+}
+
+// A sine that restarts its recurrence every control block shows any seam as sidebands at the
+// control rate, and a phase jump on a glide or settings change as a spike in the second difference
+static void testPhaseContinuity()
+{
+    std::vector<float> frames;
+
+    if (render("0 frequency 1000\n2 end\n", frames))
+        checkSpurs("control-block seams on a 1 kHz sine", frames, RENDER_WAVE, 1000.0, GOLDEN_MAX_SEAM_DB);
+    if (render("0 frequency 1000\n0 amplitude 3 0.5\n0 pan 3 0.0\n2 end\n", frames))
+        checkSpurs("control-block seams on the right bus", frames, RENDER_RIGHT, 1000.0, GOLDEN_MAX_SEAM_DB);
+
+    // Glides up and down, a modulation matrix entry and a CV sweep, all on H1
+    if (!render("0 amplitude 2 0.5\n0.2 frequency 880\n0.4 frequency 330\n0.6 matrix 2 1 40\n"
+                "0.8 cvmode 1 expfm\n0.8 cvramp 1 1.0 0.3\n1.2 end\n", frames))
+        return;
+
+    const double maxHz = 1760.0 + 40.0 * 0.5; // Highest pitch H1 reaches, the CV sweep doubles 880 Hz
+    const double omega = 2.0 * 3.14159265358979323846 * maxHz / AUDIO_SAMPLE_RATE;
+    const double limit = 1.25 * omega * omega + 4.0 / 32768.0; // A clean sine never bends faster than w^2
+    double worst = 0.0;
+    long worstFrame = 0;
+    long frameCount = (long)(frames.size() / RENDER_CHANNELS);
+
+    for (long n = AUDIO_BLOCK_SIZE * 4; n < frameCount; ++n)
+    {
+        double a = frames[(size_t)(n - 2) * RENDER_CHANNELS + RENDER_WAVE];
+        double b = frames[(size_t)(n - 1) * RENDER_CHANNELS + RENDER_WAVE];
+        double c = frames[(size_t)n * RENDER_CHANNELS + RENDER_WAVE];
+        double bend = fabs(a - 2.0 * b + c);
+        if (bend > worst)
+        {
+            worst = bend;
+            worstFrame = n;
+        }
+    }
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "worst second difference %.5f at frame %ld, limit %.5f", worst, worstFrame, limit);
+    check("phase across glides and changes", worst <= limit, detail);
+}
+
+// A control event lands on its frame inside a block: H1 stays silent up to it and starts its ramp
+// from there, and a note through the queue plays its pitch
+static void testControlEvents()
+{
+    std::vector<float> frames;
+    const double eventSeconds = 0.1003; // Frame 4814, a few frames into a block
+    const long eventFrame = (long)(eventSeconds * AUDIO_SAMPLE_RATE + 0.5);
+
+    char text[96];
+    snprintf(text, sizeof(text), "0 amplitude 1 0\n%.4f event amplitude 1 1.0\n0.3 end\n", eventSeconds);
+    if (render(text, frames))
+    {
+        double before = 0.0;
+        double after = 0.0;
+        for (long n = eventFrame - 4 * AUDIO_BLOCK_SIZE; n <= eventFrame; ++n)
+        {
+            before = std::max(before, (double)fabs(frames[(size_t)n * RENDER_CHANNELS + RENDER_WAVE]));
+        }
+        for (long n = eventFrame + 1; n <= eventFrame + 8; ++n)
+        {
+            after = std::max(after, (double)fabs(frames[(size_t)n * RENDER_CHANNELS + RENDER_WAVE]));
+        }
+
+        char detail[96];
+        snprintf(detail, sizeof(detail), "peak %.6f up to frame %ld, %.6f in the 8 after", before, eventFrame, after);
+        check("amplitude event on its frame", before == 0.0 && after > 0.0, detail);
+    }
+
+    if (render("0.0507 event frequency 660\n2 end\n", frames))
+        checkPitch("frequency event", frames, RENDER_WAVE, 660.0);
+
+    // An event posted for far ahead holds back none posted after it for sooner. The render above
+    // left H1 at full amplitude, silence it first.
+    if (!render("0 amplitude 1 0\n0.05 end\n", frames))
+        return;
+    AudioBlock block;
+    const float cvValues[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    uint32_t start = renderedFrames();
+    ControlEvent later = {start + 20000, EVENT_AMPLITUDE, 0, 0, 0.5f};
+    ControlEvent sooner = {start + 100, EVENT_AMPLITUDE, 0, 0, 1.0f};
+    postEvent(later);
+    postEvent(sooner);
+
+    long onset = -1;
+    for (int b = 0; b < 4 && onset < 0; ++b)
+    {
+        renderBlock(block, AUDIO_BLOCK_SIZE, cvValues);
+        for (int n = 0; n < AUDIO_BLOCK_SIZE && onset < 0; ++n)
+        {
+            if (block.wave[0][n] != 0)
+                onset = b * AUDIO_BLOCK_SIZE + n;
+        }
+    }
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "H1 starts at frame %ld, event on frame 100", onset);
+    check("events apply in frame order", onset == 101, detail);
+
+    // Let the far event play out so it cannot reach a later render
+    for (int b = 0; b < 20000 / AUDIO_BLOCK_SIZE + 1; ++b)
+    {
+        renderBlock(block, AUDIO_BLOCK_SIZE, cvValues);
+    }
+
+    // Values out of range play and reach the UI clamped, a NaN frequency as silence at 0 Hz
+    ControlEvent played;
+    while (nextAppliedEvent(played))
+    {
+    }
+    start = renderedFrames();
+    ControlEvent nanFrequency = {start + 10, EVENT_FREQUENCY, 0, 0, NAN};
+    ControlEvent loud = {start + 10, EVENT_AMPLITUDE, 0, 0, 1e9f};
+    ControlEvent deep = {start + 10, EVENT_MATRIX, 1, 0, -1e9f};
+    postEvent(nanFrequency);
+    postEvent(loud);
+    postEvent(deep);
+    bool finite = true;
+    for (int b = 0; b < 4; ++b)
+    {
+        renderBlock(block, AUDIO_BLOCK_SIZE, cvValues);
+        for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n)
+        {
+            finite = finite && isfinite((float)block.stereo[n]);
+        }
+    }
+    float values[3] = {-1.0f, -1.0f, -1.0f};
+    while (nextAppliedEvent(played))
+    {
+        values[played.type] = played.value;
+    }
+
+    snprintf(detail, sizeof(detail), "applied %.1f Hz, amplitude %.1f, matrix %.1f", values[EVENT_FREQUENCY],
+             values[EVENT_AMPLITUDE], values[EVENT_MATRIX]);
+    check("event values clamped", finite && values[EVENT_FREQUENCY] == 0.0f && values[EVENT_AMPLITUDE] == 1.0f && values[EVENT_MATRIX] == -100.0f, detail);
+}
+
+// Amplitude and frequency of a sine on one channel, measured over the whole cycles between the
+// first and last upward zero crossings after frame start. Returns the time the measurement stands
+// for, the middle of those cycles, which is where a linear glide passes its averages.
+static double measureSine(const std::vector<float> &frames, int channel, long start, long length,
+                          double &amplitude, double &frequency)
+{
+    double first = -1.0;
+    double last = -1.0;
+    int cycles = 0;
+    for (long n = start + 1; n < start + length; ++n)
+    {
+        double a = frames[(size_t)(n - 1) * RENDER_CHANNELS + channel];
+        double b = frames[(size_t)n * RENDER_CHANNELS + channel];
+        if (a < 0.0 && b >= 0.0)
+        {
+            double crossing = n - 1 + a / (a - b);
+            if (first < 0.0)
+                first = crossing;
+            else
+                cycles++;
+            last = crossing;
+        }
+    }
+
+    double power = 0.0;
+    long from = (long)first + 1;
+    long to = (long)last;
+    for (long n = from; n <= to; ++n)
+    {
+        double x = frames[(size_t)n * RENDER_CHANNELS + channel];
+        power += x * x;
+    }
+    amplitude = to > from ? sqrt(2.0 * power / (to - from + 1)) : 0.0;
+    frequency = cycles > 0 ? cycles * AUDIO_SAMPLE_RATE / (last - first) : 0.0;
+    return (first + last) / 2.0 / AUDIO_SAMPLE_RATE;
+}
+
+// Worst distance of H1's amplitude and pitch from the straight lines between two settings,
+// sampled every 20 ms across the morph, as a share of how far each line moves
+static void checkGlide(const char *name, const std::vector<float> &frames, double from, double to,
+                       double fromAmplitude, double toAmplitude, double fromHz, double toHz)
+{
+    const long window = AUDIO_SAMPLE_RATE / 50;
+    double worstAmplitude = 0.0;
+    double worstPitch = 0.0;
+    for (long start = (long)(from * AUDIO_SAMPLE_RATE) + window; start + 2 * window <= (long)(to * AUDIO_SAMPLE_RATE); start += window)
+    {
+        double amplitude, frequency;
+        double t = measureSine(frames, RENDER_WAVE, start, window, amplitude, frequency);
+        double along = (t - from) / (to - from);
+        double amplitudeError = fabs(amplitude - (fromAmplitude + (toAmplitude - fromAmplitude) * along)) / fabs(toAmplitude - fromAmplitude);
+        double pitchError = fabs(frequency - (fromHz + (toHz - fromHz) * along)) / fabs(toHz - fromHz);
+        worstAmplitude = std::max(worstAmplitude, amplitudeError);
+        worstPitch = std::max(worstPitch, pitchError);
+    }
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "off the line by %.2f%% in amplitude, %.2f%% in pitch", 100.0 * worstAmplitude, 100.0 * worstPitch);
+    check(name, worstAmplitude <= GOLDEN_MAX_GLIDE_ERROR && worstPitch <= GOLDEN_MAX_GLIDE_ERROR, detail);
+}
+
+// A preset morph moves amplitude and pitch in straight lines over its time, and one that takes
+// over a running morph carries on in a straight line from wherever that had got to
+static void testMorph()
+{
+    std::vector<float> frames;
+    if (render("0 amplitude 1 0.2\n"
+               "0.1 morph 1.0\n0.1 amplitude 1 1.0\n0.1 frequency 880\n"
+               "1.3 end\n", frames))
+    {
+        checkGlide("linear morph", frames, 0.1, 1.1, 0.2, 1.0, 440.0, 880.0);
+
+        double amplitude, frequency;
+        measureSine(frames, RENDER_WAVE, (long)(1.15 * AUDIO_SAMPLE_RATE), AUDIO_SAMPLE_RATE / 10, amplitude, frequency);
+        char detail[96];
+        snprintf(detail, sizeof(detail), "amplitude %.4f at %.3f Hz", amplitude, frequency);
+        check("morph lands on its settings", fabs(amplitude - 1.0) <= 0.001 && fabs(centsBetween(frequency, 880.0)) <= GOLDEN_MAX_CENTS, detail);
+    }
+
+    // Halfway, at 0.6 and 660 Hz, a half-second morph heads back
+    if (render("0 amplitude 1 0.2\n"
+               "0.1 morph 1.0\n0.1 amplitude 1 1.0\n0.1 frequency 880\n"
+               "0.6 morph 0.5\n0.6 amplitude 1 0.2\n0.6 frequency 440\n"
+               "1.3 end\n", frames))
+    {
+        checkGlide("morph before an interruption", frames, 0.1, 0.6, 0.2, 0.6, 440.0, 660.0);
+        checkGlide("morph interrupting a morph", frames, 0.6, 1.1, 0.6, 0.2, 660.0, 440.0);
+    }
+
+    // Control events every half control block keep cutting the control stage short, as pitch bend
+    // or serial automation would. They move H2, the morph on H1 keeps its pace.
+    std::string text = "0 amplitude 1 0.2\n0.1 morph 1.0\n0.1 amplitude 1 1.0\n0.1 frequency 880\n";
+    char line[64];
+    for (int i = 0; i < 2400; ++i)
+    {
+        snprintf(line, sizeof(line), "%.6f event amplitude 2 %.3f\n", 0.05 + i * 0.5 * CONTROL_BLOCK_SIZE / AUDIO_SAMPLE_RATE,
+                 0.1 + 0.1 * (i & 1));
+        text += line;
+    }
+    text += "1.3 end\n";
+    if (render(text.c_str(), frames))
+        checkGlide("morph through a stream of events", frames, 0.1, 1.1, 0.2, 1.0, 440.0, 880.0);
+}
+
+// The analyzer page's fixed-point FFT, fed from the capture ring as on the device: a sine on a bin
+// centre lights the bar holding that bin at its level, and the bars away from it stay low
+static void testAnalyzer()
+{
+    const int bin = 40;
+    const double frequency = bin * (double)CAPTURE_RATE / ANALYZER_SIZE;
+    const double levelDb = 20.0 * log10(0.5);
+
+    char text[96];
+    snprintf(text, sizeof(text), "0 amplitude 1 0.5\n0 frequency %.4f\n0.05 end\n", frequency);
+    std::vector<float> frames;
+    if (!render(text, frames))
+        return;
+
+    AudioBlock block;
+    const float cvValues[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int b = 0; b < 2 * ANALYZER_SIZE * CAPTURE_DECIMATION / AUDIO_BLOCK_SIZE; ++b)
+    {
+        renderBlock(block, AUDIO_BLOCK_SIZE, cvValues);
+        captureBlock(block, AUDIO_BLOCK_SIZE);
+        pollCapture();
+    }
+    while (!stepAnalyzer())
+    {
+    }
+
+    uint8_t bars[ANALYZER_BARS];
+    analyzerBars(bars, ANALYZER_RANGE_DB); // Whole dB above the bottom of the range
+    int peak = (int)(std::max_element(bars, bars + ANALYZER_BARS) - bars);
+    int expected = analyzerColumn((float)frequency);
+    int floor = 0;
+    for (int x = 0; x < ANALYZER_BARS; ++x)
+    {
+        if (abs(x - expected) > 8)
+            floor = std::max(floor, (int)bars[x]);
+    }
+    double measuredDb = bars[peak] - ANALYZER_RANGE_DB;
+    double floorDb = floor - ANALYZER_RANGE_DB;
+
+    char detail[96];
+    snprintf(detail, sizeof(detail), "bar %d at %.0f dB for bar %d at %.1f dB, %.0f dB elsewhere", peak, measuredDb,
+             expected, levelDb, floorDb);
+    check("analyzer bin and level", abs(peak - expected) <= 1 && fabs(measuredDb - levelDb) <= 1.5 && floorDb <= levelDb - 40.0, detail);
+}
+
+int main()
+{
+    initWavetables();
+    initPitch();
+    initAnalyzer();
+
+    printf("%d partials, %s\n", numPartials, SYNTH_FIXED_POINT ? "fixed point" : "float");
+    testPitch();
+    testTuning();
+    testAliasing();
+    testPhaseContinuity();
+    testControlEvents();
+    testMorph();
+    testAnalyzer();
+
+    printf("%d check%s failed\n", failures, failures == 1 ? "" : "s");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/*
+ * File: synth_render.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+// Render a settings script through the engine into a WAV file with one channel per output: left,
+// right, stereo mix and the individual wave outputs. See render.h for the script format.
+//
+//   synth_render <script | -> <output.wav>
+
+#include "render.h"
+#include "pitch.h"
+#include "wavetable.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <script | -> <output.wav>\n", argv[0]);
+        return 1;
+    }
+
+    std::stringstream text;
+    if (std::string(argv[1]) == "-")
+    {
+        text << std::cin.rdbuf();
+    }
+    else
+    {
+        std::ifstream file(argv[1]);
+        if (!file)
+        {
+            fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+            return 1;
+        }
+        text << file.rdbuf();
+    }
+
+    RenderScript script;
+    std::string error;
+    if (!parseRenderScript(text.str(), script, error))
+    {
+        fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return 1;
+    }
+
+    initWavetables();
+    initPitch();
+
+    std::vector<float> frames;
+    renderScript(script, frames);
+    if (!writeWav(argv[2], frames, RENDER_CHANNELS, AUDIO_SAMPLE_RATE))
+    {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[2]);
+        return 1;
+    }
+
+    printf("%s: %.2f s, %d channels at %d Hz, %d partials, %s\n", argv[2], script.duration, RENDER_CHANNELS,
+           AUDIO_SAMPLE_RATE, numPartials, SYNTH_FIXED_POINT ? "fixed point" : "float");
+    return 0;
+}
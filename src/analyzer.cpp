@@ -0,0 +1,275 @@
+/*
+ * File: analyzer.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "analyzer.h"
+#include "tables.h"
+#include <math.h>
+
+// The real frames pack pairwise into half as many complex points, and a radix-4 transform of those
+// runs log4 of that many stages of a quarter as many butterflies each
+#define FFT_POINTS (ANALYZER_SIZE / 2)
+#define FFT_STAGES 4
+#define FFT_BUTTERFLIES (FFT_POINTS / 4)
+
+static_assert(FFT_POINTS == 1 << (2 * FFT_STAGES), "The transform is pure radix-4");
+static_assert(FFT_POINTS == numSamples, "Twiddles come straight from the sine table");
+
+// Levels are kept in quarter dB above the bottom of the range
+#define LEVEL_STEPS_PER_DB 4
+#define LEVEL_TOP (ANALYZER_RANGE_DB * LEVEL_STEPS_PER_DB)
+
+enum AnalyzerPhase
+{
+    ANALYZER_LOAD,      // Window the newest frames into the work buffer, in digit-reversed order
+    ANALYZER_TRANSFORM, // Butterflies, ANALYZER_BUTTERFLIES_PER_STEP at a time
+    ANALYZER_SPLIT      // Unpack the real spectrum and fold its bins into the bars
+};
+
+static int32_t workReal[FFT_POINTS];
+static int32_t workImag[FFT_POINTS];
+static int16_t window[ANALYZER_SIZE];      // Hann, Q15
+static int16_t splitCos[FFT_POINTS];       // cos(pi k / FFT_POINTS), Q15
+static int16_t splitSin[FFT_POINTS];       // sin(pi k / FFT_POINTS), Q15
+static uint16_t barFirstBin[ANALYZER_BARS]; // Low bars are narrower than a bin and share it
+static uint16_t barLastBin[ANALYZER_BARS];
+static uint16_t binLevel[FFT_POINTS];
+static uint16_t barLevel[ANALYZER_BARS];
+
+static AnalyzerPhase phase = ANALYZER_LOAD;
+static int nextButterfly = 0; // Counted across all stages
+
+static const float binHz = (float)CAPTURE_RATE / ANALYZER_SIZE;
+static const float maxHz = CAPTURE_RATE / 2.0f;
+
+// cos and sin of 2 pi m / FFT_POINTS, the sine table holds exactly one cycle of that many points
+static inline int32_t twiddleCos(int m)
+{
+    return sineTableQ15[(m + FFT_POINTS / 4) & (FFT_POINTS - 1)];
+}
+
+static inline int32_t twiddleSin(int m)
+{
+    return sineTableQ15[m & (FFT_POINTS - 1)];
+}
+
+static inline int32_t multiplyQ15(int32_t value, int32_t coefficient)
+{
+    return (int32_t)(((int64_t)value * coefficient) >> 15);
+}
+
+// Base-4 digits of an index in reverse, the order a decimation-in-time radix-4 transform reads
+static inline int digitReverse(int index)
+{
+    int reversed = 0;
+    for (int d = 0; d < FFT_STAGES; ++d)
+    {
+        reversed = (reversed << 2) | (index & 3);
+        index >>= 2;
+    }
+    return reversed;
+}
+
+void initAnalyzer()
+{
+    const float pi = (float)M_PI;
+    for (int n = 0; n < ANALYZER_SIZE; ++n)
+    {
+        window[n] = (int16_t)lroundf(16383.5f * (1.0f - cosf(2.0f * pi * n / ANALYZER_SIZE)));
+    }
+    for (int k = 0; k < FFT_POINTS; ++k)
+    {
+        splitCos[k] = (int16_t)lroundf(32767.0f * cosf(pi * k / FFT_POINTS));
+        splitSin[k] = (int16_t)lroundf(32767.0f * sinf(pi * k / FFT_POINTS));
+    }
+
+    // Bars share the axis evenly in log frequency, each covering the bins that fall inside it or,
+    // narrower than a bin, the nearest one
+    for (int x = 0; x < ANALYZER_BARS; ++x)
+    {
+        float low = ANALYZER_MIN_HZ * powf(maxHz / ANALYZER_MIN_HZ, (float)x / ANALYZER_BARS);
+        float high = ANALYZER_MIN_HZ * powf(maxHz / ANALYZER_MIN_HZ, (float)(x + 1) / ANALYZER_BARS);
+        int first = (int)(low / binHz + 0.5f);
+        int last = (int)(high / binHz + 0.5f) - 1;
+        first = first < FFT_POINTS - 1 ? first : FFT_POINTS - 1;
+        last = last > first ? (last < FFT_POINTS - 1 ? last : FFT_POINTS - 1) : first;
+        barFirstBin[x] = (uint16_t)first;
+        barLastBin[x] = (uint16_t)last;
+    }
+}
+
+int analyzerColumn(float frequency)
+{
+    if (frequency <= ANALYZER_MIN_HZ)
+        return 0;
+    int x = (int)(ANALYZER_BARS * logf(frequency / ANALYZER_MIN_HZ) / logf(maxHz / ANALYZER_MIN_HZ));
+    return x < ANALYZER_BARS ? x : ANALYZER_BARS - 1;
+}
+
+// Even frames go to the real parts and odd frames to the imaginary parts, oldest first
+static void loadFrames()
+{
+    for (int n = 0; n < FFT_POINTS; ++n)
+    {
+        int age = ANALYZER_SIZE - 1 - 2 * n;
+        int target = digitReverse(n);
+        workReal[target] = (capturedFrame(age).stereo * window[2 * n]) >> 15;
+        workImag[target] = (capturedFrame(age - 1).stereo * window[2 * n + 1]) >> 15;
+    }
+}
+
+// One radix-4 butterfly, scaled by a quarter so every stage keeps the values inside Q15 magnitudes
+static void butterfly(int index)
+{
+    int stage = index / FFT_BUTTERFLIES;
+    int within = index - stage * FFT_BUTTERFLIES;
+    int quarter = 1 << (2 * stage); // Distance between the butterfly's legs
+    int span = quarter * 4;
+    int group = within / quarter;
+    int k = within - group * quarter;
+    int i0 = group * span + k;
+    int step = k * (FFT_POINTS / span);
+
+    int32_t ar = workReal[i0], ai = workImag[i0];
+    int32_t br = workReal[i0 + quarter], bi = workImag[i0 + quarter];
+    int32_t cr = workReal[i0 + 2 * quarter], ci = workImag[i0 + 2 * quarter];
+    int32_t dr = workReal[i0 + 3 * quarter], di = workImag[i0 + 3 * quarter];
+
+    // Twiddle the legs by e^(-2 pi i r step / FFT_POINTS), r = 1, 2, 3
+    if (step != 0)
+    {
+        int32_t t;
+        t = multiplyQ15(br, twiddleCos(step)) + multiplyQ15(bi, twiddleSin(step));
+        bi = multiplyQ15(bi, twiddleCos(step)) - multiplyQ15(br, twiddleSin(step));
+        br = t;
+        t = multiplyQ15(cr, twiddleCos(2 * step)) + multiplyQ15(ci, twiddleSin(2 * step));
+        ci = multiplyQ15(ci, twiddleCos(2 * step)) - multiplyQ15(cr, twiddleSin(2 * step));
+        cr = t;
+        t = multiplyQ15(dr, twiddleCos(3 * step)) + multiplyQ15(di, twiddleSin(3 * step));
+        di = multiplyQ15(di, twiddleCos(3 * step)) - multiplyQ15(dr, twiddleSin(3 * step));
+        dr = t;
+    }
+
+    int32_t sumAcR = ar + cr, sumAcI = ai + ci;
+    int32_t diffAcR = ar - cr, diffAcI = ai - ci;
+    int32_t sumBdR = br + dr, sumBdI = bi + di;
+    int32_t diffBdR = br - dr, diffBdI = bi - di;
+
+    workReal[i0] = (sumAcR + sumBdR) >> 2;
+    workImag[i0] = (sumAcI + sumBdI) >> 2;
+    workReal[i0 + quarter] = (diffAcR + diffBdI) >> 2; // (a - c) - i (b - d)
+    workImag[i0 + quarter] = (diffAcI - diffBdR) >> 2;
+    workReal[i0 + 2 * quarter] = (sumAcR - sumBdR) >> 2;
+    workImag[i0 + 2 * quarter] = (sumAcI - sumBdI) >> 2;
+    workReal[i0 + 3 * quarter] = (diffAcR - diffBdI) >> 2; // (a - c) + i (b - d)
+    workImag[i0 + 3 * quarter] = (diffAcI + diffBdR) >> 2;
+}
+
+// log2 in Q8 from the leading bit and the next eight below it, within a few hundredths of an octave
+static inline int32_t log2Q8(uint64_t value)
+{
+    if (value == 0)
+        return 0;
+    int whole = 63 - __builtin_clzll(value);
+    int32_t fraction = whole >= 8 ? (int32_t)(value >> (whole - 8)) & 0xFF : (int32_t)(value << (8 - whole)) & 0xFF;
+    return (whole << 8) + fraction;
+}
+
+// Recover the bins of the real frames from the packed transform,
+// X[k] = (Z[k] + Z*[N - k]) / 2 - i e^(-i pi k / N) (Z[k] - Z*[N - k]) / 2, then keep each bar's loudest
+static void splitSpectrum()
+{
+    // A full-scale sine through the Hann window and the scaled stages peaks at 2^14, power 2^28
+    const int32_t fullScaleLog2Q8 = 28 << 8;
+    const int32_t dbPerOctaveQ8 = 771; // 10 log10(2) per octave of power, in Q8
+
+    for (int k = barFirstBin[0]; k <= barLastBin[ANALYZER_BARS - 1]; ++k)
+    {
+        int mirror = (FFT_POINTS - k) & (FFT_POINTS - 1);
+        int32_t evenR = (workReal[k] + workReal[mirror]) >> 1;
+        int32_t evenI = (workImag[k] - workImag[mirror]) >> 1;
+        int32_t oddR = (workImag[k] + workImag[mirror]) >> 1; // -i (Z[k] - Z*[N - k]) / 2
+        int32_t oddI = (workReal[mirror] - workReal[k]) >> 1;
+
+        // Rotate the odd part by e^(-i pi k / N)
+        int32_t real = evenR + multiplyQ15(oddR, splitCos[k]) + multiplyQ15(oddI, splitSin[k]);
+        int32_t imag = evenI + multiplyQ15(oddI, splitCos[k]) - multiplyQ15(oddR, splitSin[k]);
+
+        uint64_t power = (uint64_t)((int64_t)real * real) + (uint64_t)((int64_t)imag * imag);
+        int32_t db = (int32_t)(((int64_t)(log2Q8(power) - fullScaleLog2Q8) * dbPerOctaveQ8) >> 16); // Whole dB below full scale
+        int32_t level = (db + ANALYZER_RANGE_DB) * LEVEL_STEPS_PER_DB;
+        binLevel[k] = (uint16_t)(power == 0 || level < 0 ? 0 : level > LEVEL_TOP ? LEVEL_TOP : level);
+    }
+
+    // Bars rise at once and sink slowly
+    for (int x = 0; x < ANALYZER_BARS; ++x)
+    {
+        int loudest = 0;
+        for (int k = barFirstBin[x]; k <= barLastBin[x]; ++k)
+        {
+            loudest = binLevel[k] > loudest ? binLevel[k] : loudest;
+        }
+        int fallen = barLevel[x] - ANALYZER_FALL_DB * LEVEL_STEPS_PER_DB;
+        barLevel[x] = (uint16_t)(loudest > fallen ? loudest : fallen > 0 ? fallen : 0);
+    }
+}
+
+bool stepAnalyzer()
+{
+    switch (phase)
+    {
+    case ANALYZER_LOAD:
+        loadFrames();
+        nextButterfly = 0;
+        phase = ANALYZER_TRANSFORM;
+        return false;
+    case ANALYZER_TRANSFORM:
+    {
+        int end = nextButterfly + ANALYZER_BUTTERFLIES_PER_STEP;
+        end = end < FFT_STAGES * FFT_BUTTERFLIES ? end : FFT_STAGES * FFT_BUTTERFLIES;
+        for (; nextButterfly < end; ++nextButterfly)
+        {
+            butterfly(nextButterfly);
+        }
+        if (nextButterfly == FFT_STAGES * FFT_BUTTERFLIES)
+            phase = ANALYZER_SPLIT;
+        return false;
+    }
+    case ANALYZER_SPLIT:
+    default:
+        splitSpectrum();
+        phase = ANALYZER_LOAD;
+        return true;
+    }
+}
+
+void analyzerBars(uint8_t bars[ANALYZER_BARS], int height)
+{
+    for (int x = 0; x < ANALYZER_BARS; ++x)
+    {
+        bars[x] = (uint8_t)(barLevel[x] * height / LEVEL_TOP);
+    }
+}
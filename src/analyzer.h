@@ -0,0 +1,59 @@
+/*
+ * File: analyzer.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <stdint.h>
+#include "capture.h"
+
+// Spectrum of the captured stereo bus for the analyzer view. ANALYZER_SIZE real frames go through a
+// Q15 radix-4 FFT of half that many complex points, spread over several UI frames so no single
+// frame pays for a whole transform. The capture stream runs at CAPTURE_RATE, so the view spans up
+// to CAPTURE_RATE / 2, and the renderer's output above that folds back into it undecimated.
+#define ANALYZER_SIZE 512 // Frames per transform, at most CAPTURE_HISTORY
+#define ANALYZER_BARS 128 // One per display column, on a log frequency axis
+#define ANALYZER_MIN_HZ 50.0f
+#define ANALYZER_RANGE_DB 72              // From full scale down to the bottom of the bars
+#define ANALYZER_BUTTERFLIES_PER_STEP 128 // Half the transform, so a spectrum takes four steps
+#define ANALYZER_FALL_DB 3                // A bar sinks at most this far per spectrum, so peaks linger
+
+static_assert(ANALYZER_SIZE <= CAPTURE_HISTORY, "The analyzer transforms frames from the capture history");
+
+void initAnalyzer();
+
+// Do the next share of the running transform, starting a new one from the newest frames once the
+// last is done. Returns true when the step finished a spectrum.
+bool stepAnalyzer();
+
+// Bar heights in pixels, 0 at -ANALYZER_RANGE_DB below full scale up to height at full scale
+void analyzerBars(uint8_t bars[ANALYZER_BARS], int height);
+
+// Display column of a frequency on the bar axis
+int analyzerColumn(float frequency);
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * File: audio.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "audio.h"
+#include "synth.h"
+#include "dac.h"
+#include "cv.h"
+#include "capture.h"
+#include "events.h"
+#include "profile.h"
+#include <Arduino.h>
+#include <driver/i2s.h>
+#include <esp_timer.h>
+
+static AudioBlock audioBlock;
+static volatile uint32_t audioLoad = 0;
+static volatile uint32_t audioOverruns = 0;
+static uint32_t blockCycles = 1; // CPU cycles one block lasts, set by initAudio()
+
+// Fold the time a block took to render, interrupt or task, into the load and the overrun count
+static void IRAM_ATTR recordBlockLoad(uint32_t startCycles)
+{
+    static uint32_t smoothedLoad = 0; // Percent, in 1/16ths
+
+    uint32_t load = (uint32_t)((uint64_t)(ESP.getCycleCount() - startCycles) * 100 / blockCycles);
+    if (load >= 100)
+    {
+        audioOverruns = audioOverruns + 1;
+    }
+    smoothedLoad += load - (smoothedLoad >> 4); // About a 16-block time constant
+    audioLoad = smoothedLoad >> 4;
+}
+
+#if AUDIO_USE_I2S
+
+// The MCP4725 outputs take every DAC_DECIMATION-th frame
+static int dacCountdown = 0;
+
+// Queue the frames of a rendered block that fall on the MCP4725 frame clock
+static void IRAM_ATTR queueBlockToExternalDACs(int frames)
+{
+    sample_t waveSamples[numWaveOutputs];
+
+    for (int n = 0; n < frames; ++n)
+    {
+        if (--dacCountdown > 0)
+            continue;
+        dacCountdown = DAC_DECIMATION;
+
+        for (int i = 0; i < numWaveOutputs; ++i)
+        {
+            waveSamples[i] = audioBlock.wave[i][n];
+        }
+        queueExternalDACs(audioBlock.left[n], audioBlock.right[n], audioBlock.stereo[n], waveSamples);
+    }
+}
+
+#define AUDIO_I2S_PORT I2S_NUM_0   // Only I2S0 can drive the built-in DAC
+#define AUDIO_DMA_BUFFER_COUNT 4   // Blocks of output latency queued in DMA
+
+static TaskHandle_t audioTaskHandle = NULL;
+static uint16_t i2sBuffer[AUDIO_BLOCK_SIZE * 2]; // Interleaved frames, two 16-bit slots each
+
+// The built-in DAC converts the upper 8 bits of each 16-bit slot
+static inline uint16_t IRAM_ATTR toBuiltInDAC(sample_t sample)
+{
+    return (uint16_t)(toDac8(sample) << 8);
+}
+
+// Render blocks forever; i2s_write() blocks until a DMA buffer frees up, which paces the loop.
+// Everything between the writes runs from IRAM and the I2S interrupt is IRAM-safe, but i2s_write()
+// itself is driver code in flash. A flash write, which only saving a preset makes, still holds
+// this task up, and the DMA queue plays through it only as far as its AUDIO_DMA_BUFFER_COUNT blocks.
+static void IRAM_ATTR audioTask(void *parameter)
+{
+    float cvValues[4];
+
+    for (;;)
+    {
+        uint32_t startCycles = ESP.getCycleCount();
+
+        // CV is acquired continuously elsewhere, take the latest values for this block
+        readCV(cvValues);
+
+        // Control inputs stamp their events against when each block starts
+        markRenderClock(renderedFrames(), esp_timer_get_time());
+        renderBlock(audioBlock, AUDIO_BLOCK_SIZE, cvValues);
+
+        uint32_t outputCycles = profileStart();
+
+        // In 16-bit mode the first slot of each frame is the right I2S channel, which the
+        // built-in DAC routes to DAC1 (GPIO25, left output) and the second to DAC2 (GPIO26)
+        for (int n = 0; n < AUDIO_BLOCK_SIZE; ++n)
+        {
+            i2sBuffer[2 * n] = toBuiltInDAC(audioBlock.left[n]);
+            i2sBuffer[2 * n + 1] = toBuiltInDAC(audioBlock.right[n]);
+        }
+
+        // The MCP4725s cannot follow the audio rate over I2C, their task takes a decimated stream
+        queueBlockToExternalDACs(AUDIO_BLOCK_SIZE);
+        captureBlock(audioBlock, AUDIO_BLOCK_SIZE);
+        profileEnd(PROFILE_OUTPUT, outputCycles);
+        profileEnd(PROFILE_AUDIO, startCycles);
+        recordBlockLoad(startCycles); // An overrun shrinks the DMA queue by a block, a few more and it runs dry
+
+        size_t bytesWritten;
+        i2s_write(AUDIO_I2S_PORT, i2sBuffer, sizeof(i2sBuffer), &bytesWritten, portMAX_DELAY);
+    }
+}
+
+void initAudio()
+{
+    blockCycles = (uint32_t)((uint64_t)ESP.getCpuFreqMHz() * 1000000 * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE);
+
+    i2s_config_t config = {};
+    config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN);
+    config.sample_rate = AUDIO_SAMPLE_RATE;
+    config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT;
+    config.communication_format = I2S_COMM_FORMAT_STAND_MSB;
+    config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1 | ESP_INTR_FLAG_IRAM; // The handler runs on while the cache is off
+    config.dma_buf_count = AUDIO_DMA_BUFFER_COUNT;
+    config.dma_buf_len = AUDIO_BLOCK_SIZE;
+    config.use_apll = false;
+
+    i2s_driver_install(AUDIO_I2S_PORT, &config, 0, NULL);
+    i2s_set_pin(AUDIO_I2S_PORT, NULL); // NULL routes the output to the built-in DAC
+    i2s_set_dac_mode(I2S_DAC_CHANNEL_BOTH_EN);
+    i2s_zero_dma_buffer(AUDIO_I2S_PORT);
+
+    // Audio runs at the highest priority on the application core
+    xTaskCreatePinnedToCore(audioTask, "audio", 4096, NULL, configMAX_PRIORITIES - 1, &audioTaskHandle, 1);
+}
+
+#else
+
+// Timer for the sine wave generation
+hw_timer_t *timer = NULL;
+
+// Timer interrupt service routine to generate waveforms
+void IRAM_ATTR onTimer()
+{
+    uint32_t startCycles = profileStart();
+    uint32_t loadCycles = ESP.getCycleCount();
+    float cvValues[4];
+    sample_t waveSamples[numWaveOutputs];
+
+    // Read CV inputs
+    readCV(cvValues);
+
+    markRenderClock(renderedFrames(), esp_timer_get_time());
+    renderBlock(audioBlock, 1, cvValues);
+    captureBlock(audioBlock, 1);
+    for (int i = 0; i < numWaveOutputs; ++i)
+    {
+        waveSamples[i] = audioBlock.wave[i][0];
+    }
+
+    // Output the sample values to the DACs
+    uint32_t outputCycles = profileStart();
+    outputToDACs(audioBlock.left[0], audioBlock.right[0], audioBlock.stereo[0], waveSamples);
+    profileEnd(PROFILE_OUTPUT, outputCycles);
+    profileEnd(PROFILE_AUDIO, startCycles);
+    recordBlockLoad(loadCycles); // An overrun here is a sample interrupt that missed the next one
+}
+
+void initAudio()
+{
+    blockCycles = (uint32_t)((uint64_t)ESP.getCpuFreqMHz() * 1000000 * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE);
+
+    // Set up the timer interrupt for sine wave generation
+    timer = timerBegin(0, 80, true); // Timer 0, prescaler 80, count up
+    timerAttachInterrupt(timer, &onTimer, true);
+    timerAlarmWrite(timer, 1000000 / AUDIO_SAMPLE_RATE, true); // 1 second / sampleRate
+    timerAlarmEnable(timer);
+}
+
+#endif
+
+uint32_t getAudioLoad()
+{
+    return audioLoad;
+}
+
+uint32_t getAudioOverruns()
+{
+    return audioOverruns;
+}
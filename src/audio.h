@@ -0,0 +1,61 @@
+/*
+ * File: audio.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+
+// Select the render path: 1 renders blocks into the I2S DMA feeding the built-in DAC,
+// 0 falls back to rendering one sample per hardware timer interrupt
+#ifndef AUDIO_USE_I2S
+#define AUDIO_USE_I2S 1
+#endif
+
+#if AUDIO_USE_I2S
+#define AUDIO_SAMPLE_RATE 48000 // 44100 also works, any rate the I2S clock divider can reach
+#define AUDIO_BLOCK_SIZE 64     // Frames rendered per block, 32-256
+#else
+#define AUDIO_SAMPLE_RATE 1000 // Limited by the cost of one interrupt per sample
+#define AUDIO_BLOCK_SIZE 1
+#endif
+
+#if AUDIO_USE_I2S && (AUDIO_BLOCK_SIZE < 32 || AUDIO_BLOCK_SIZE > 256)
+#error "AUDIO_BLOCK_SIZE must be between 32 and 256 frames"
+#endif
+
+void initAudio();
+
+// Share of the block period spent rendering, in percent and lightly smoothed, on either render path.
+// On the timer path a block is one sample interrupt. Lower-priority work watches it to get out of
+// the way when audio runs short of headroom.
+uint32_t getAudioLoad();
+
+// Blocks, or sample interrupts, that took longer to render than they last, only ever incremented
+uint32_t getAudioOverruns();
+
+#endif
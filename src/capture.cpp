@@ -0,0 +1,80 @@
+/*
+ * File: capture.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "capture.h"
+#include "ring.h"
+
+static SpscRing<CaptureFrame, CAPTURE_RING_SIZE> captureRing;
+static int decimationCountdown = 0;
+
+static CaptureFrame history[CAPTURE_HISTORY];
+static uint32_t historyHead = 0; // Frames written so far, the newest sits at historyHead - 1
+
+static inline int16_t IRAM_ATTR toCaptureSample(sample_t sample)
+{
+#if SYNTH_FIXED_POINT
+    int32_t value = sample;
+#else
+    int32_t value = (int32_t)(sample * 32767.0f);
+#endif
+    return (int16_t)(value < -32767 ? -32767 : value > 32767 ? 32767 : value);
+}
+
+void IRAM_ATTR captureBlock(const AudioBlock &block, int frames)
+{
+    for (int n = 0; n < frames; ++n)
+    {
+        if (--decimationCountdown > 0)
+            continue;
+        decimationCountdown = CAPTURE_DECIMATION;
+
+        CaptureFrame frame;
+        frame.left = toCaptureSample(block.left[n]);
+        frame.right = toCaptureSample(block.right[n]);
+        frame.stereo = toCaptureSample(block.stereo[n]);
+        captureRing.push(frame);
+    }
+}
+
+void pollCapture()
+{
+    CaptureFrame frame;
+    while (captureRing.pop(frame))
+    {
+        history[historyHead++ & (CAPTURE_HISTORY - 1)] = frame;
+    }
+}
+
+const CaptureFrame &capturedFrame(int age)
+{
+    return history[(historyHead - 1 - age) & (CAPTURE_HISTORY - 1)];
+}
+
+uint32_t captureCount()
+{
+    return historyHead;
+}
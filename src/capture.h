@@ -0,0 +1,61 @@
+/*
+ * File: capture.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include "synth.h"
+
+// The renderer hands a decimated copy of its output buses to the visualizers through a lock-free
+// ring, so the scope views show what actually reaches the jacks
+#define CAPTURE_RATE_TARGET 12000
+#define CAPTURE_DECIMATION (AUDIO_SAMPLE_RATE > CAPTURE_RATE_TARGET ? AUDIO_SAMPLE_RATE / CAPTURE_RATE_TARGET : 1)
+#define CAPTURE_RATE (AUDIO_SAMPLE_RATE / CAPTURE_DECIMATION)
+#define CAPTURE_RING_SIZE 1024 // About 85 ms at 12 kHz, several UI frames of slack
+#define CAPTURE_HISTORY 512    // Frames the UI keeps for triggering and plotting, a power of two
+
+// One captured frame, Q15 and clipped the way the DACs clip
+struct CaptureFrame
+{
+    int16_t left;
+    int16_t right;
+    int16_t stereo;
+};
+
+// Audio side, never blocks. Frames find no room while nobody drains the ring and are dropped.
+void captureBlock(const AudioBlock &block, int frames);
+
+// UI side, single consumer. pollCapture() moves everything waiting into the history, which
+// capturedFrame() reads back by age, 0 being the newest frame.
+void pollCapture();
+const CaptureFrame &capturedFrame(int age);
+
+// Frames moved into the history so far, a view compares it with its last read to find the new ones
+uint32_t captureCount();
+
+#endif
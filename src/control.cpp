@@ -0,0 +1,327 @@
+/*
+ * File: control.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#include "control.h"
+#include "profile.h"
+#include "synth.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <math.h>
+#include <string.h>
+#if CONTROL_USB_MIDI
+#include "USB.h"
+#include "esp32-hal-tinyusb.h"
+#endif
+
+#define MIDI_BAUD 31250
+#define CONTROL_IDLE_MS 20 // Longest sleep without a receive wakeup, a missed one costs at most this
+#define NRPN_NONE 0x3FFF   // Parameter number once an RPN deselects the NRPN
+
+static TaskHandle_t controlTaskHandle = NULL;
+static HardwareSerial &midiSerial = Serial2;
+
+// A MIDI byte stream, UART and USB each keep their own so a message split across reads survives
+struct MidiParser
+{
+    uint8_t status; // Running status, 0 while no channel message is under way
+    uint8_t data[2];
+    uint8_t count;
+    uint16_t nrpn;
+    uint8_t dataMsb;
+};
+
+static MidiParser uartMidi = {0, {0, 0}, 0, NRPN_NONE, 0};
+#if CONTROL_USB_MIDI
+static MidiParser usbMidi = {0, {0, 0}, 0, NRPN_NONE, 0};
+#endif
+
+// Frame in progress on the serial protocol: sync, type, payload and checksum
+struct ProtocolParser
+{
+    uint8_t bytes[12];
+    int length;
+    int expected;
+};
+
+static ProtocolParser protocol = {{0}, 0, 0};
+static volatile uint32_t controlDrops = 0;
+
+// Queue a change for the engine, which passes it on to the UI once it plays it. A change that finds
+// the queue full is counted and never shows, the UI only mirrors what the engine played.
+static bool sendChange(uint8_t type, int source, int target, float value, uint32_t frame)
+{
+    ControlEvent event = {frame, type, (uint8_t)source, (uint8_t)target, value};
+    if (postEvent(event))
+        return true;
+    controlDrops++;
+    return false;
+}
+
+static void applyNrpn(const MidiParser &parser, int value, uint32_t frame)
+{
+    int parameter = parser.nrpn >> 7;
+    int index = parser.nrpn & 0x7F;
+    if (parser.nrpn == NRPN_NONE || index >= numPartials)
+        return;
+
+    if (parameter == 0)
+    {
+        sendChange(EVENT_AMPLITUDE, index, 0, value / 16383.0f, frame);
+    }
+    else if (parameter <= numPartials)
+    {
+        float amount = (value - 8192) * (100.0f / 8191.0f);
+        sendChange(EVENT_MATRIX, parameter - 1, index, amount < -100.0f ? -100.0f : amount, frame);
+    }
+}
+
+static void controlChange(MidiParser &parser, int controller, int value, uint32_t frame)
+{
+    switch (controller)
+    {
+    case 99: // NRPN MSB and LSB
+        parser.nrpn = (uint16_t)((value << 7) | (parser.nrpn & 0x7F));
+        break;
+    case 98:
+        parser.nrpn = (uint16_t)((parser.nrpn & 0x3F80) | value);
+        break;
+    case 101: // Selecting an RPN leaves data entry to it
+    case 100:
+        parser.nrpn = NRPN_NONE;
+        break;
+    case 6: // Data entry, the MSB applies at once and the LSB refines it
+        parser.dataMsb = (uint8_t)value;
+        applyNrpn(parser, value << 7, frame);
+        break;
+    case 38:
+        applyNrpn(parser, (parser.dataMsb << 7) | value, frame);
+        break;
+    default:
+        if (controller >= MIDI_CC_AMPLITUDE && controller < MIDI_CC_AMPLITUDE + 12 && controller - MIDI_CC_AMPLITUDE < numPartials)
+            sendChange(EVENT_AMPLITUDE, controller - MIDI_CC_AMPLITUDE, 0, value / 127.0f, frame);
+        break;
+    }
+}
+
+static void midiByte(MidiParser &parser, uint8_t byte, uint32_t frame)
+{
+    if (byte >= 0xF8)
+        return; // Real-time messages can fall between the bytes of any other
+    if (byte & 0x80)
+    {
+        // Channel messages set the running status, system messages clear it
+        parser.status = byte < 0xF0 ? byte : 0;
+        parser.count = 0;
+        return;
+    }
+    if (parser.status == 0)
+        return; // System message data, SysEx included
+
+    parser.data[parser.count++] = byte;
+    int kind = parser.status & 0xF0;
+    int needed = (kind == 0xC0 || kind == 0xD0) ? 1 : 2;
+    if (parser.count < needed)
+        return;
+    parser.count = 0;
+
+    if (MIDI_CHANNEL != 0 && (parser.status & 0x0F) != MIDI_CHANNEL - 1)
+        return;
+    if (kind == 0x90 && parser.data[1] > 0)
+        sendChange(EVENT_FREQUENCY, 0, 0, MIDI_NOTE_HZ * powf(2.0f, (parser.data[0] - 69) / 12.0f), frame);
+    else if (kind == 0xB0)
+        controlChange(parser, parser.data[0], parser.data[1], frame);
+}
+
+#if CONTROL_USB_MIDI
+// USB-MIDI event packets carry one message each, the code index number says how many bytes
+static void usbMidiPacket(const uint8_t packet[4], uint32_t frame)
+{
+    int codeIndex = packet[0] & 0x0F;
+    if (codeIndex < 0x8)
+        return; // SysEx and system common, nothing here uses them
+    int length = (codeIndex == 0xC || codeIndex == 0xD) ? 2 : codeIndex == 0xF ? 1 : 3;
+    for (int i = 1; i <= length; ++i)
+    {
+        midiByte(usbMidi, packet[i], frame);
+    }
+}
+#endif
+
+static int payloadLength(uint8_t type)
+{
+    switch (type)
+    {
+    case 1:
+        return 6;
+    case 2:
+        return 7;
+    case 3:
+        return 8;
+    default:
+        return -1;
+    }
+}
+
+// False for a NaN or infinity, which no setting can take
+static bool readFloat(const uint8_t *bytes, float &value)
+{
+    memcpy(&value, bytes, sizeof(value)); // Little endian, as the ESP32
+    return isfinite(value);
+}
+
+static void serialByte(uint8_t byte, uint32_t frame)
+{
+    ProtocolParser &p = protocol;
+    if (p.length == 0)
+    {
+        if (byte == CONTROL_SYNC)
+            p.length = 1;
+        else
+            profilerCommand(byte);
+        return;
+    }
+
+    p.bytes[p.length++] = byte;
+    if (p.length == 2)
+    {
+        int payload = payloadLength(byte);
+        p.length = payload < 0 ? 0 : p.length; // Unknown type, wait for the next sync
+        p.expected = payload + 3;
+        return;
+    }
+    if (p.length < p.expected)
+        return;
+    p.length = 0;
+
+    uint8_t checksum = 0;
+    for (int i = 1; i < p.expected; ++i)
+    {
+        checksum ^= p.bytes[i];
+    }
+    if (checksum != 0)
+        return;
+
+    const uint8_t *payload = p.bytes + 2;
+    frame += payload[0] | (payload[1] << 8);
+    float value;
+    bool queued = true;
+    switch (p.bytes[1])
+    {
+    case 1:
+        if (readFloat(payload + 2, value))
+            queued = sendChange(EVENT_FREQUENCY, 0, 0, value, frame);
+        break;
+    case 2:
+        if (payload[2] >= 1 && payload[2] <= numPartials && readFloat(payload + 3, value))
+            queued = sendChange(EVENT_AMPLITUDE, payload[2] - 1, 0, value, frame);
+        break;
+    case 3:
+        if (payload[2] >= 1 && payload[2] <= numPartials && payload[3] >= 1 && payload[3] <= numPartials && readFloat(payload + 4, value))
+            queued = sendChange(EVENT_MATRIX, payload[2] - 1, payload[3] - 1, value, frame);
+        break;
+    }
+    if (!queued)
+    {
+        Serial.write(CONTROL_QUEUE_FULL);
+        Serial.write(p.bytes[1]);
+    }
+}
+
+static void wakeControl()
+{
+    xTaskNotifyGive(controlTaskHandle);
+}
+
+#if CONTROL_USB_MIDI
+extern "C" void tud_midi_rx_cb(uint8_t itf)
+{
+    wakeControl();
+}
+
+static uint16_t loadMidiDescriptor(uint8_t *dst, uint8_t *itf)
+{
+    uint8_t name = tinyusb_add_string_descriptor("Osmos MIDI");
+    uint8_t endpointIn = tinyusb_get_free_in_endpoint();
+    uint8_t endpointOut = tinyusb_get_free_out_endpoint();
+    TU_VERIFY(endpointIn && endpointOut);
+    uint8_t descriptor[TUD_MIDI_DESC_LEN] = {TUD_MIDI_DESCRIPTOR(*itf, name, endpointOut, (uint8_t)(0x80 | endpointIn), 64)};
+    *itf += 2; // Audio control and MIDI streaming
+    memcpy(dst, descriptor, TUD_MIDI_DESC_LEN);
+    return TUD_MIDI_DESC_LEN;
+}
+#endif
+
+// Everything that arrived since the last wakeup shares one stamp, it all came in together
+static void controlTask(void *parameter)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONTROL_IDLE_MS));
+        uint32_t frame = frameAt(esp_timer_get_time()) + EVENT_LATENCY_FRAMES;
+
+        while (midiSerial.available() > 0)
+        {
+            midiByte(uartMidi, (uint8_t)midiSerial.read(), frame);
+        }
+        while (Serial.available() > 0)
+        {
+            serialByte((uint8_t)Serial.read(), frame);
+        }
+#if CONTROL_USB_MIDI
+        uint8_t packet[4];
+        while (tud_midi_available() && tud_midi_packet_read(packet))
+        {
+            usbMidiPacket(packet, frame);
+        }
+#endif
+    }
+}
+
+uint32_t getControlDrops()
+{
+    return controlDrops;
+}
+
+void initControl()
+{
+    xTaskCreatePinnedToCore(controlTask, "control", 3072, NULL, CONTROL_TASK_PRIORITY, &controlTaskHandle, 0);
+
+    // Wake on every receive timeout of a symbol, a message is never left waiting in the FIFO
+    midiSerial.begin(MIDI_BAUD, SERIAL_8N1, MIDI_RX_PIN, -1);
+    midiSerial.setRxTimeout(1);
+    midiSerial.onReceive(wakeControl);
+#if !ARDUINO_USB_CDC_ON_BOOT
+    Serial.setRxTimeout(1);
+    Serial.onReceive(wakeControl);
+#endif
+
+#if CONTROL_USB_MIDI
+    tinyusb_enable_interface(USB_INTERFACE_MIDI, TUD_MIDI_DESC_LEN, loadMidiDescriptor);
+    USB.begin();
+#endif
+}
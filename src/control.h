@@ -0,0 +1,76 @@
+/*
+ * File: control.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+#include "events.h"
+
+// External control: MIDI on a UART, USB-MIDI where the board has native USB, and a binary protocol
+// on the Serial port the profiler already answers on. One task on core 0 parses all of them and stamps
+// each change for the engine, see events.h.
+#define MIDI_RX_PIN 16       // UART2 receive, through the usual 6N138 opto-isolator
+#define MIDI_CHANNEL 1       // 1 to 16, or 0 to listen on every channel
+#define MIDI_NOTE_HZ 440.0f  // Frequency of MIDI note 69, A4
+#define MIDI_CC_AMPLITUDE 20 // CC 20 to 31 set H1 to H12, NRPN reaches every harmonic
+#define CONTROL_TASK_PRIORITY (tskIDLE_PRIORITY + 4) // Above the CV sampler, stamping needs to be prompt
+
+// USB-MIDI needs the TinyUSB MIDI class, which only the chips with native USB have
+#ifndef CONTROL_USB_MIDI
+#if defined(CONFIG_TINYUSB_MIDI_ENABLED) && CONFIG_TINYUSB_MIDI_ENABLED
+#define CONTROL_USB_MIDI 1
+#else
+#define CONTROL_USB_MIDI 0
+#endif
+#endif
+
+// MIDI
+//   Note on              base frequency to the note, equal tempered from MIDI_NOTE_HZ; note off is ignored
+//   CC 20-31             amplitude of H1-H12, 0 to 127 as 0.0 to 1.0
+//   NRPN 0, n            amplitude of harmonic n + 1, 14-bit data entry as 0.0 to 1.0
+//   NRPN s, t (s >= 1)   modulation from harmonic s to harmonic t + 1, 14-bit data entry as -100 to 100
+//
+// Serial protocol, little endian, frames of
+//   0xA5, type, payload, checksum (XOR of type and payload)
+//   type 1, frequency    delay u16, Hz f32
+//   type 2, amplitude    delay u16, harmonic u8 from 1, amplitude f32
+//   type 3, matrix       delay u16, source u8 from 1, target u8 from 1, amount f32
+// Each change sounds EVENT_LATENCY_FRAMES plus delay frames after its frame arrives, so a sequencer
+// can send a bundle of changes ahead in one write and have them land exactly apart. A NaN or
+// infinite value drops its frame, the engine holds the rest to the editors' ranges: 0 Hz to
+// Nyquist, amplitude 0.0 to 1.0, amount -100 to 100. A frame that finds the event queue full is
+// answered with CONTROL_QUEUE_FULL and its type, send it again later. MIDI has no way back, its
+// drops only count in getControlDrops(). Bytes outside a frame are profiler commands, see profile.h.
+#define CONTROL_SYNC 0xA5
+#define CONTROL_QUEUE_FULL 0x15 // ASCII NAK, never part of the profiler's text
+
+void initControl();
+uint32_t getControlDrops(); // Changes from any input lost to a full event queue
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * File: cv.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "cv.h"
+#include "profile.h"
+#include <Arduino.h>
+#include <atomic>
+#include <driver/adc.h>
+
+// On the ESP32 the ADC's DMA path runs through I2S0, which already streams audio to the built-in
+// DAC, so the conversions are driven by a sampler task on the protocol core instead
+#define CV_TASK_PRIORITY (tskIDLE_PRIORITY + 3)
+
+// ADC1 channels behind CV_PIN_1..4 (GPIO34, 35, 36 and 39)
+static const adc1_channel_t cvChannels[CV_INPUT_COUNT] = {ADC1_CHANNEL_6, ADC1_CHANNEL_7, ADC1_CHANNEL_0, ADC1_CHANNEL_3};
+
+static CvCalibration cvCalibration[CV_INPUT_COUNT] = {
+    {0.0f, 1.0f / 4095.0f}, {0.0f, 1.0f / 4095.0f}, {0.0f, 1.0f / 4095.0f}, {0.0f, 1.0f / 4095.0f}};
+
+// Published values, each channel is a single word so readers never see a torn update
+static std::atomic<float> cvOutputs[CV_INPUT_COUNT];
+static TaskHandle_t cvTaskHandle = NULL;
+
+// Average CV_OVERSAMPLE conversions per channel, calibrate, smooth and publish
+static void cvTask(void *parameter)
+{
+    float filtered[CV_INPUT_COUNT] = {0.0f};
+    TickType_t lastWake = xTaskGetTickCount();
+    const TickType_t period = pdMS_TO_TICKS(1000 / CV_SAMPLE_RATE);
+
+    for (;;)
+    {
+        uint32_t startCycles = profileStart();
+        for (int i = 0; i < CV_INPUT_COUNT; ++i)
+        {
+            int sum = 0;
+            for (int k = 0; k < CV_OVERSAMPLE; ++k)
+            {
+                sum += adc1_get_raw(cvChannels[i]);
+            }
+
+            float raw = (float)sum * (1.0f / CV_OVERSAMPLE);
+            float value = (raw - cvCalibration[i].offset) * cvCalibration[i].scale;
+            filtered[i] += CV_SMOOTHING * (value - filtered[i]);
+            cvOutputs[i].store(filtered[i], std::memory_order_relaxed);
+        }
+        profileEnd(PROFILE_CV, startCycles);
+
+        vTaskDelayUntil(&lastWake, period);
+    }
+}
+
+void initCV()
+{
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    for (int i = 0; i < CV_INPUT_COUNT; ++i)
+    {
+        adc1_config_channel_atten(cvChannels[i], ADC_ATTEN_DB_11); // Full 0-3.3V range, as analogRead()
+        cvOutputs[i].store(0.0f, std::memory_order_relaxed);
+    }
+
+    xTaskCreatePinnedToCore(cvTask, "cv", 2048, NULL, CV_TASK_PRIORITY, &cvTaskHandle, 0);
+}
+
+void IRAM_ATTR readCV(float cvValues[])
+{
+    for (int i = 0; i < CV_INPUT_COUNT; ++i)
+    {
+        cvValues[i] = cvOutputs[i].load(std::memory_order_relaxed);
+    }
+}
+
+void setCVCalibration(int channel, CvCalibration calibration)
+{
+    if (channel >= 0 && channel < CV_INPUT_COUNT)
+    {
+        cvCalibration[channel] = calibration;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * File: cv.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef CV_H
+#define CV_H
+
+// Define the ADC input pins for CV
+#define CV_PIN_1 34
+#define CV_PIN_2 35
+#define CV_PIN_3 36
+#define CV_PIN_4 39
+#define CV_INPUT_COUNT 4
+
+// The CV inputs are sampled continuously off the audio core and decimated to CV_SAMPLE_RATE
+#define CV_SAMPLE_RATE 500 // Decimated samples per second on every channel, a whole number of ticks
+#define CV_OVERSAMPLE 4    // Raw conversions averaged into each decimated sample
+#define CV_SMOOTHING 0.5f  // One-pole coefficient applied after decimation, 1.0 disables it
+
+// Maps raw 12-bit ADC codes onto the nominal 0.0-1.0 CV range: (raw - offset) * scale
+struct CvCalibration
+{
+    float offset;
+    float scale;
+};
+
+void initCV();
+void readCV(float cvValues[]); // Latest value of every channel, never blocks, safe from the ISR
+void setCVCalibration(int channel, CvCalibration calibration);
+
+#endif
@@ -26,47 +26,241 @@
  */
 
 #include "Dac.h"
+#include "ring.h"
+#include "profile.h"
+#include <Arduino.h>
+#include <Wire.h>
 #include <driver/Dac.h>
+#include <hal/dac_ll.h>
 
-// Define the DAC output pins (DAC1: GPIO 25, DAC2: GPIO 26 for ESP32)
-#define DAC_PIN_1 25
-#define DAC_PIN_2 26
+// Built-in DAC channels (DAC1: GPIO 25, DAC2: GPIO 26 for ESP32)
+#define DAC_PIN_1 DAC_CHANNEL_1
+#define DAC_PIN_2 DAC_CHANNEL_2
 
 // Create MCP4725 DAC instances
 Adafruit_MCP4725 dac1;
 Adafruit_MCP4725 dac2;
 Adafruit_MCP4725 dacStereo;
-Adafruit_MCP4725 dacWave[7]; // DACs for individual wave outputs
+Adafruit_MCP4725 dacWave[numWaveOutputs]; // DACs for individual wave outputs
+
+// Where each output is wired. Every MCP4725 only offers 0x60-0x67, so no bus carries more than
+// eight, and the split keeps both buses equally loaded.
+struct DacChannel
+{
+    uint8_t bus;
+    uint8_t muxChannel; // TCA9548A channel, or DAC_NO_MUX
+    uint8_t address;
+};
+
+#if DAC_USE_MUX
+static const DacChannel dacChannels[DAC_OUTPUT_COUNT] = {
+    {0, 0, 0x60}, {0, 0, 0x61}, {0, 0, 0x62}, {0, 1, 0x60}, {0, 1, 0x61}, // Left, right, stereo, H1, H2
+    {1, 0, 0x60}, {1, 0, 0x61}, {1, 0, 0x62}, {1, 1, 0x60}, {1, 1, 0x61}, // H3-H7
+};
+#else
+static const DacChannel dacChannels[DAC_OUTPUT_COUNT] = {
+    {0, DAC_NO_MUX, 0x60}, {0, DAC_NO_MUX, 0x61}, {0, DAC_NO_MUX, 0x62}, {0, DAC_NO_MUX, 0x63}, {0, DAC_NO_MUX, 0x64},
+    {1, DAC_NO_MUX, 0x60}, {1, DAC_NO_MUX, 0x61}, {1, DAC_NO_MUX, 0x62}, {1, DAC_NO_MUX, 0x63}, {1, DAC_NO_MUX, 0x64},
+};
+#endif
+
+static Adafruit_MCP4725 *const dacDevices[DAC_OUTPUT_COUNT] = {
+    &dac1, &dac2, &dacStereo,
+    &dacWave[0], &dacWave[1], &dacWave[2], &dacWave[3], &dacWave[4], &dacWave[5], &dacWave[6],
+};
+
+// Each bus owns a ring fed by the renderer and a task that drains it
+struct DacBus
+{
+    TwoWire *wire;
+    SpscRing<DacFrame, DAC_RING_SIZE> ring;
+    TaskHandle_t task;
+    uint8_t outputs[DAC_OUTPUT_COUNT]; // Outputs on this bus, grouped by mux channel
+    int outputCount;
+    uint8_t muxChannel; // Channel currently selected on this bus's mux
+    volatile DacStats stats;
+};
+
+static DacBus dacBuses[DAC_BUS_COUNT];
+static bool dacPresent[DAC_OUTPUT_COUNT];
+static hw_timer_t *dacTimer = NULL;
+
+// Route a bus through the mux channel an output sits on, skipping the write when already there
+static void selectMuxChannel(DacBus &bus, uint8_t muxChannel)
+{
+    if (muxChannel == DAC_NO_MUX || muxChannel == bus.muxChannel)
+        return;
+
+    bus.wire->beginTransmission(DAC_MUX_ADDRESS);
+    bus.wire->write((uint8_t)(1 << muxChannel));
+    if (bus.wire->endTransmission() == 0)
+    {
+        bus.muxChannel = muxChannel;
+    }
+    else
+    {
+        bus.muxChannel = DAC_NO_MUX; // Unknown, select again on the next write
+        bus.stats.i2cErrors++;
+    }
+}
+
+// MCP4725 fast mode write: two data bytes with the power-down bits cleared, no EEPROM update.
+// Returns false when the device did not acknowledge.
+static bool fastWrite(TwoWire *wire, uint8_t address, uint16_t code)
+{
+    wire->beginTransmission(address);
+    wire->write((uint8_t)(code >> 8));
+    wire->write((uint8_t)(code & 0xFF));
+    return wire->endTransmission() == 0;
+}
+
+// Pace every bus task at DAC_FRAME_RATE
+static void IRAM_ATTR onDacTimer()
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    for (int b = 0; b < DAC_BUS_COUNT; ++b)
+    {
+        vTaskNotifyGiveFromISR(dacBuses[b].task, &higherPriorityTaskWoken);
+    }
+    if (higherPriorityTaskWoken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Drain one frame per timer tick, repeating the last frame when the renderer falls behind. While
+// one bus task waits on its controller the other runs, so both buses transfer at the same time.
+static void dacTask(void *parameter)
+{
+    DacBus &bus = *(DacBus *)parameter;
+    ProfileProbe probe = (ProfileProbe)(PROFILE_DAC_BUS + (&bus - dacBuses));
+    DacFrame frame;
+    bool streaming = false;
+    bool reversed = false;
+
+    for (int i = 0; i < DAC_OUTPUT_COUNT; ++i)
+    {
+        frame.codes[i] = 2048;
+    }
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t startCycles = profileStart();
+
+        if (bus.ring.pop(frame))
+        {
+            streaming = true;
+        }
+        else if (streaming)
+        {
+            bus.stats.underruns++;
+        }
+
+        // Behind a mux, alternate frames walk the outputs in opposite directions. Each frame then starts
+        // on the channel the last one ended on and needs a single select.
+        for (int k = 0; k < bus.outputCount; ++k)
+        {
+            int output = bus.outputs[reversed ? bus.outputCount - 1 - k : k];
+            selectMuxChannel(bus, dacChannels[output].muxChannel);
+            if (!fastWrite(bus.wire, dacChannels[output].address, frame.codes[output]))
+            {
+                bus.stats.i2cErrors++;
+            }
+        }
+        reversed = DAC_USE_MUX && !reversed;
+        bus.stats.framesWritten++;
+        profileEnd(probe, startCycles);
+    }
+}
 
 void initDACs()
 {
     dac_output_enable(DAC_PIN_1);
     dac_output_enable(DAC_PIN_2);
-    dac1.begin(0x60);      // Default I2C address for MCP4725
-    dac2.begin(0x61);      // Second I2C address for MCP4725
-    dacStereo.begin(0x62); // Third I2C address for MCP4725
-    for (int i = 0; i < 7; ++i)
+
+    Wire.begin();
+    Wire1.begin(DAC_BUS1_SDA, DAC_BUS1_SCL);
+    dacBuses[0].wire = &Wire;
+    dacBuses[1].wire = &Wire1;
+
+    for (int b = 0; b < DAC_BUS_COUNT; ++b)
+    {
+        DacBus &bus = dacBuses[b];
+        bus.wire->setClock(400000);
+        bus.outputCount = 0;
+        bus.muxChannel = DAC_NO_MUX;
+
+        // Schedule the outputs mux channel by mux channel so each frame switches as few times as possible
+        for (int muxChannel = 0; muxChannel <= DAC_NO_MUX; ++muxChannel)
+        {
+            for (int i = 0; i < DAC_OUTPUT_COUNT; ++i)
+            {
+                const DacChannel &channel = dacChannels[i];
+                if (channel.bus != b || channel.muxChannel != muxChannel)
+                    continue;
+
+                selectMuxChannel(bus, channel.muxChannel);
+                dacPresent[i] = dacDevices[i]->begin(channel.address, bus.wire);
+                if (dacPresent[i])
+                {
+                    bus.outputs[bus.outputCount++] = i;
+                }
+            }
+        }
+    }
+
+    // The output tasks sit just below the audio renderer on the same core
+    xTaskCreatePinnedToCore(dacTask, "dac0", 2048, &dacBuses[0], configMAX_PRIORITIES - 2, &dacBuses[0].task, 1);
+    xTaskCreatePinnedToCore(dacTask, "dac1", 2048, &dacBuses[1], configMAX_PRIORITIES - 2, &dacBuses[1].task, 1);
+
+    // Timer 1 paces the output tasks, timer 0 belongs to the fallback audio path
+    dacTimer = timerBegin(1, 80, true);
+    timerAttachInterrupt(dacTimer, &onDacTimer, true);
+    timerAlarmWrite(dacTimer, (uint64_t)DAC_DECIMATION * 1000000 / AUDIO_SAMPLE_RATE, true);
+    timerAlarmEnable(dacTimer);
+}
+
+// Runs from the fallback audio timer interrupt. dac_output_voltage() is flash-resident driver code
+// behind a spinlock, so the codes go straight to the RTC pad registers instead; dac_output_enable()
+// in initDACs() has already powered the pads.
+void IRAM_ATTR outputToDACs(sample_t leftSample, sample_t rightSample, sample_t stereoSample, const sample_t waveSamples[])
+{
+    // Output the sample values to the DACs as 8-bit codes
+    dac_ll_update_output_value(DAC_PIN_1, toDac8(leftSample));
+    dac_ll_update_output_value(DAC_PIN_2, toDac8(rightSample));
+    queueExternalDACs(leftSample, rightSample, stereoSample, waveSamples);
+}
+
+void IRAM_ATTR queueExternalDACs(sample_t leftSample, sample_t rightSample, sample_t stereoSample, const sample_t waveSamples[])
+{
+    DacFrame frame;
+    frame.codes[DAC_LEFT] = toDac12(leftSample);
+    frame.codes[DAC_RIGHT] = toDac12(rightSample);
+    frame.codes[DAC_STEREO] = toDac12(stereoSample);
+    for (int i = 0; i < numWaveOutputs; ++i)
+    {
+        frame.codes[DAC_WAVE + i] = toDac12(waveSamples[i]);
+    }
+
+    for (int b = 0; b < DAC_BUS_COUNT; ++b)
     {
-        dacWave[i].begin(0x63 + i); // Assuming sequential I2C addresses for individual wave outputs
+        if (!dacBuses[b].ring.push(frame))
+        {
+            dacBuses[b].stats.overruns++;
+        }
     }
 }
 
-void outputToDACs(float leftSample, float rightSample, float stereoSample, float waveSamples[])
+DacStats getDacStats()
 {
-    // Convert the sample values to DAC output range
-    int dacValueLeft = (int)((leftSample + 1.0) * 127.5);      // Convert to 0-255 range
-    int dacValueRight = (int)((rightSample + 1.0) * 127.5);    // Convert to 0-255 range
-    int dacValueStereo = (int)((stereoSample + 1.0) * 2047.5); // Convert to 0-4095 range
-
-    // Output the sample values to the DACs
-    dac_output_voltage(DAC_PIN_1, dacValueLeft);
-    dac_output_voltage(DAC_PIN_2, dacValueRight);
-    dacStereo.setVoltage(dacValueStereo, false);
-
-    // Output individual wave samples to DACs
-    for (int i = 0; i < 7; ++i)
+    DacStats stats = {0, 0, 0, 0};
+    for (int b = 0; b < DAC_BUS_COUNT; ++b)
     {
-        int dacValueWave = (int)((waveSamples[i] + 1.0) * 2047.5); // Convert to 0-4095 range
-        dacWave[i].setVoltage(dacValueWave, false);
+        stats.framesWritten += dacBuses[b].stats.framesWritten;
+        stats.underruns += dacBuses[b].stats.underruns;
+        stats.overruns += dacBuses[b].stats.overruns;
+        stats.i2cErrors += dacBuses[b].stats.i2cErrors;
     }
+    return stats;
 }
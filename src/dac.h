@@ -28,15 +28,72 @@
 #ifndef DAC_H
 #define DAC_H
 
+#include <stdint.h>
 #include <Adafruit_MCP4725.h>
+#include "synth.h"
+#include "oled.h"
+
+// The MCP4725 outputs are spread over both I2C controllers, each drained by its own task, so the
+// per-frame write time is set by the busier bus rather than by all ten devices in a row
+#define DAC_BUS_COUNT 2
+#define DAC_BUS1_SDA 18 // Wire1, Wire stays on the default pins shared with the display
+#define DAC_BUS1_SCL 19
+
+// Set to 1 when the outputs sit behind a TCA9548A on each bus instead of being wired straight to it
+#ifndef DAC_USE_MUX
+#define DAC_USE_MUX 0
+#endif
+#define DAC_MUX_ADDRESS 0x70
+#define DAC_NO_MUX 0xFF
+
+// Frames per second refreshed on every output. Each bus makes one fast write per output per frame,
+// plus one mux select when the outputs sit behind a mux, see dacTask(). Those may fill at most
+// DAC_BUS_SHARE percent of the bus time, the rest is headroom for a late task. Bus 0 also carries
+// the display, so its share shrinks by OLED_BUS_SHARE and sets the frame rate of both buses. The
+// renderer hands over every DAC_DECIMATION-th frame.
+#define DAC_OUTPUTS_PER_BUS 5 // Of DAC_OUTPUT_COUNT, split evenly by the channel tables in dac.cpp
+#define DAC_TRANSACTIONS_PER_FRAME (DAC_OUTPUTS_PER_BUS + (DAC_USE_MUX ? 1 : 0))
+#define DAC_TRANSACTION_US 100 // One write or select at 400 kHz, with the driver's overhead
+#define DAC_BUS_SHARE 70
+#define DAC_FRAME_SHARE (DAC_BUS_SHARE - OLED_BUS_SHARE) // Of bus 0, in percent
+#define DAC_DECIMATION ((int)((AUDIO_SAMPLE_RATE * DAC_TRANSACTIONS_PER_FRAME * DAC_TRANSACTION_US * 100ULL / DAC_FRAME_SHARE + 999999) / 1000000))
+#define DAC_FRAME_RATE (AUDIO_SAMPLE_RATE / DAC_DECIMATION)
+#define DAC_RING_SIZE 64 // Frames of slack between the renderer and each bus task, a power of two
+
+// MCP4725 outputs, in frame order
+enum DacOutput
+{
+    DAC_LEFT,
+    DAC_RIGHT,
+    DAC_STEREO,
+    DAC_WAVE, // First of the individual wave outputs
+    DAC_OUTPUT_COUNT = DAC_WAVE + numWaveOutputs
+};
+
+// One frame of quantized 12-bit codes for the MCP4725 outputs
+struct DacFrame
+{
+    uint16_t codes[DAC_OUTPUT_COUNT];
+};
+
+// Output health counters, only ever incremented and summed over the buses
+struct DacStats
+{
+    uint32_t framesWritten;
+    uint32_t underruns; // A bus task found its ring empty and repeated the last frame
+    uint32_t overruns;  // Renderer found a bus ring full and dropped the frame for that bus
+    uint32_t i2cErrors; // Transactions a device or mux did not acknowledge
+};
 
 // Create MCP4725 DAC instances
 extern Adafruit_MCP4725 dac1;
 extern Adafruit_MCP4725 dac2;
 extern Adafruit_MCP4725 dacStereo;
-extern Adafruit_MCP4725 dacWave[7]; // DACs for individual wave outputs
+extern Adafruit_MCP4725 dacWave[numWaveOutputs]; // DACs for individual wave outputs
 
 void initDACs();
-void outputToDACs(float leftSample, float rightSample, float stereoSample, float waveSamples[]);
+void outputToDACs(sample_t leftSample, sample_t rightSample, sample_t stereoSample, const sample_t waveSamples[]);
+void queueExternalDACs(sample_t leftSample, sample_t rightSample, sample_t stereoSample, const sample_t waveSamples[]); // Never blocks
+DacStats getDacStats();
 
 #endif
@@ -26,28 +26,41 @@
  */
 
 #include "Display.h"
+#include "synth.h"
+#include "oled.h"
+#include "capture.h"
+#include "analyzer.h"
+#include "tables.h"
+#include "presets.h"
+#include "tuning.h"
+#include "bitmap.h"
 #include <Arduino.h> // For random function
 
-extern Adafruit_SSD1305 display;
+// Create SSD1305 display instance
+Adafruit_SSD1305 display(128, 64, &Wire, OLED_RESET);
+
 extern float harmonicAmplitudes[];
 extern float harmonicPanning[];
 extern float baseFrequency;
 extern int harmonicIndex;
 extern int menuIndex;
+extern int scaleIndex;
 extern MenuMode currentMenu;
-extern float modulationMatrix[7][7];
+extern float modulationMatrix[numPartials][numPartials];
 extern CVMode cvAssignments[];
 extern bool xySwapped;
 extern float xyBiasX;
 extern float xyBiasY;
-extern const char *scaleNames[];
+extern bool xyPersistence;
 extern const char *waveformNames[];
 
+// The effects run in Q8 fixed point, 256 is one pixel per frame or full life
+#define EFFECT_ONE 256
+
 struct Particle
 {
-    int x, y;
-    int dx, dy;
-    uint16_t color;
+    int32_t x, y;   // Q8 pixels
+    int8_t dx, dy;  // -1, 0 or 1
 };
 
 #define MAX_PARTICLES 50
@@ -55,11 +68,10 @@ Particle particles[MAX_PARTICLES];
 
 struct Ripple
 {
-    int x, y;
-    float radius;
-    float speed;
-    float amplitude;
-    float life;
+    int16_t x, y;
+    int32_t radius; // Q8 pixels
+    int32_t speed;  // Q8 pixels per frame
+    int32_t life;   // Q8, fades from EFFECT_ONE to 0
 };
 
 #define MAX_RIPPLES 10
@@ -67,28 +79,41 @@ Ripple ripples[MAX_RIPPLES];
 
 void initDisplay()
 {
-    display.begin(SSD1305_SWITCHCAPVCC, OLED_ADDRESS);
-    display.display(); // Initialize with a blank display
-    delay(1000);       // Pause for 1 second
-    display.clearDisplay();
+    display.begin(SSD1305_SWITCHCAPVCC, OLED_I2C_ADDRESS);
+    invalidateDisplay();
+    initDisplayFlush();
+
+    // Display the loading screen
+    drawBitmap(epd_bitmap_stone_eye, 67, 67);
+}
 
+void initEffects()
+{
     // Initialize particles
     for (int i = 0; i < MAX_PARTICLES; ++i)
     {
-        particles[i] = {random(128), random(64), random(3) - 1, random(3) - 1, WHITE};
+        particles[i] = {(int32_t)random(128) * EFFECT_ONE, (int32_t)random(64) * EFFECT_ONE, (int8_t)(random(3) - 1), (int8_t)(random(3) - 1)};
     }
 
     // Initialize ripples
     for (int i = 0; i < MAX_RIPPLES; ++i)
     {
-        ripples[i] = {random(128), random(64), 0, random(1, 5) / 10.0, harmonicAmplitudes[i % 7], 1.0};
+        ripples[i] = {(int16_t)random(128), (int16_t)random(64), 0, (int32_t)random(1, 5) * EFFECT_ONE / 10, EFFECT_ONE};
     }
 }
 
+// Preset slot the popup's load, morph and save entries act on, starting on the one last used
+static int presetSlot = -1;
+
 void drawPopupMenu(int index)
 {
+    if (presetSlot < 0)
+    {
+        presetSlot = lastPresetSlot() < 0 ? 0 : lastPresetSlot();
+    }
+
     display.clearDisplay();
-    const char *popupItems[] = {"Option 1", "Option 2", "Option 3", "Option 4", "Option 5", "Option 6", "Option 7"};
+    const char *popupItems[] = {"Preset ", "Load Preset", "Morph To Preset", "Save Preset", "Option 5", "Option 6", "Option 7"};
     for (int i = 0; i < 7; ++i)
     {
         display.setCursor(0, i * 8);
@@ -101,14 +126,97 @@ void drawPopupMenu(int index)
             display.print("  ");
         }
         display.print(popupItems[i]);
+        if (i == 0)
+        {
+            display.print(presetSlot + 1);
+            display.print(presetExists(presetSlot) ? "" : " (empty)");
+        }
     }
-    display.display();
+    presentDisplay();
 }
 
-void handlePopupSelection(int index)
+bool handlePopupSelection(int index)
+{
+    switch (index)
+    {
+    case 0:
+        presetSlot = (presetSlot + 1) % PRESET_SLOTS;
+        return true; // Stay open to pick the slot
+    case 1:
+        loadPreset(presetSlot, 0.0f);
+        break;
+    case 2:
+        loadPreset(presetSlot, PRESET_MORPH_SECONDS);
+        break;
+    case 3:
+        savePreset(presetSlot);
+        break;
+    default:
+        break;
+    }
+    return false;
+}
+
+// Scope trace geometry, one captured frame per column
+#define SCOPE_WIDTH 128
+#define SCOPE_MIN_SPAN 1024 // Signals smaller than about 3% of full scale free-run
+#define SCOPE_MATCH_STEP 4   // Column spacing when comparing traces
+
+// Set a pixel straight in a page-ordered 1-bit buffer such as the framebuffer, clipped to the panel
+static inline void plotPixel(uint8_t *frame, int x, int y)
+{
+    if (x >= 0 && x < OLED_WIDTH && y >= 0 && y < OLED_HEIGHT)
+    {
+        frame[(y >> 3) * OLED_WIDTH + x] |= (uint8_t)(1 << (y & 7));
+    }
+}
+
+// XY plot state, see drawXYOscilloscope()
+#define XY_POINTS 256
+#define XY_DECAY_PHASES 8
+static uint8_t xyBuffer[OLED_PAGES][OLED_WIDTH];
+static uint32_t xyLastCount = 0;
+static int xyDecayPhase = 0;
+
+// Rows of a scrolling list below a page title
+#define LIST_ROWS 7
+
+// First entry shown so the cursor stays in view, centred once the list runs longer than the page
+static int listWindowStart(int cursor, int count, int rows)
+{
+    int first = cursor - rows / 2;
+    if (first > count - rows)
+        first = count - rows;
+    return first < 0 ? 0 : first;
+}
+
+// Preview of the combined waveform, one cycle across the panel. Each harmonic's column contribution
+// is its Q8 amplitude times the Q15 sine table, so a changed amplitude is folded in as an exact integer
+// difference and untouched harmonics cost nothing.
+#define PREVIEW_COLUMNS 128
+#define PREVIEW_AMPLITUDE_ONE 256
+
+static int32_t previewSum[PREVIEW_COLUMNS];
+static int32_t previewAmplitude[numPartials];
+
+static_assert(numSamples % PREVIEW_COLUMNS == 0, "The preview reads the sine table at a whole stride");
+
+static void updateWaveformPreview()
 {
-    // Handle the selected option from the popup menu
-    // Add your option handling code here
+    for (int i = 0; i < numPartials; ++i)
+    {
+        int32_t amplitude = (int32_t)lroundf(harmonicAmplitudes[i] * PREVIEW_AMPLITUDE_ONE);
+        int32_t delta = amplitude - previewAmplitude[i];
+        if (delta == 0)
+            continue;
+        previewAmplitude[i] = amplitude;
+
+        const int stride = (i + 1) * (numSamples / PREVIEW_COLUMNS);
+        for (int x = 0; x < PREVIEW_COLUMNS; ++x)
+        {
+            previewSum[x] += delta * sineTableQ15[(x * stride) & (numSamples - 1)];
+        }
+    }
 }
 
 void drawWaveforms()
@@ -116,21 +224,19 @@ void drawWaveforms()
     display.clearDisplay();
 
     // Draw the combined waveform
-    for (int x = 0; x < 128; ++x)
+    updateWaveformPreview();
+    for (int x = 0; x < PREVIEW_COLUMNS; ++x)
     {
-        float sample = 0.0;
-        for (int i = 0; i < 7; ++i)
-        {
-            sample += harmonicAmplitudes[i] * sin(2.0 * PI * (i + 1) * x / 128.0);
-        }
-        int y = 32 + (int)(sample * 16); // Center at 32, scale to 16 pixels
+        // Center at 32, scale to 16 pixels
+        int y = 32 + (int)((previewSum[x] * 16LL) >> 23);
         display.drawPixel(x, y, WHITE);
     }
 
     // Display harmonic amplitudes and the current scale
-    for (int i = 0; i < 7; ++i)
+    int first = listWindowStart(harmonicIndex, numPartials, LIST_ROWS);
+    for (int i = first; i < first + LIST_ROWS && i < numPartials; ++i)
     {
-        display.setCursor(0, i * 8);
+        display.setCursor(0, (i - first) * 8);
         display.print("H");
         display.print(i + 1);
         display.print(": ");
@@ -143,25 +249,31 @@ void drawWaveforms()
 
     display.setCursor(0, 56);
     display.print("Scale: ");
-    display.print(scaleNames[currentMenu]);
+    display.print(scales[scaleIndex].name);
     display.setCursor(64, 56);
     display.print("Freq: ");
     display.print(baseFrequency, 1);
-    display.display();
+    presentDisplay();
 }
 
 void drawAmplitudeBars()
 {
     display.clearDisplay();
 
-    for (int i = 0; i < 7; ++i)
+    // Bars share the width, numbered while there is room for the digits
+    const int pitch = 128 / numPartials > 1 ? 128 / numPartials : 1;
+    const int width = pitch > 2 ? pitch - 2 : pitch;
+    for (int i = 0; i < numPartials && i * pitch < 128; ++i)
     {
         int barHeight = (int)(harmonicAmplitudes[i] * 64);
-        display.fillRect(i * 18, 64 - barHeight, 16, barHeight, WHITE);
-        display.setCursor(i * 18, 64 - barHeight - 8);
-        display.print(i + 1);
+        display.fillRect(i * pitch, 64 - barHeight, width, barHeight, WHITE);
+        if (pitch >= 12)
+        {
+            display.setCursor(i * pitch, 64 - barHeight - 8);
+            display.print(i + 1);
+        }
     }
-    display.display();
+    presentDisplay();
 }
 
 void drawMenu()
@@ -172,10 +284,13 @@ void drawMenu()
     if (currentMenu == SCALE_MENU)
     {
         display.print("Select Scale:");
-        for (int i = 0; i < 4; ++i)
+
+        // Seven rows fit below the title, the list scrolls to keep the cursor on them
+        int first = menuIndex > 6 ? menuIndex - 6 : 0;
+        for (int i = first; i < scaleCount && i < first + 7; ++i)
         {
-            display.setCursor(0, (i + 1) * 8);
-            display.print(scaleNames[i]);
+            display.setCursor(0, (i - first + 1) * 8);
+            display.print(scales[i].name);
             if (i == menuIndex)
             {
                 display.print(" <-");
@@ -200,9 +315,10 @@ void drawMenu()
         display.print("Modulate H");
         display.print(harmonicIndex + 1);
         display.print(" with:");
-        for (int i = 0; i < 7; ++i)
+        int first = listWindowStart(menuIndex, numPartials, LIST_ROWS);
+        for (int i = first; i < first + LIST_ROWS && i < numPartials; ++i)
         {
-            display.setCursor(0, (i + 1) * 8);
+            display.setCursor(0, (i - first + 1) * 8);
             display.print("H");
             display.print(i + 1);
             display.print(": ");
@@ -217,9 +333,10 @@ void drawMenu()
     {
         display.print("Panning H");
         display.print(harmonicIndex + 1);
-        for (int i = 0; i < 7; ++i)
+        int first = listWindowStart(menuIndex, numPartials, LIST_ROWS);
+        for (int i = first; i < first + LIST_ROWS && i < numPartials; ++i)
         {
-            display.setCursor(0, (i + 1) * 8);
+            display.setCursor(0, (i - first + 1) * 8);
             display.print("H");
             display.print(i + 1);
             display.print(": ");
@@ -287,12 +404,31 @@ void drawMenu()
         display.setCursor(0, 8);
         display.print("Swap Channels: ");
         display.print(xySwapped ? "On" : "Off");
+        if (menuIndex == 0)
+        {
+            display.print(" <-");
+        }
         display.setCursor(0, 16);
         display.print("Bias X: ");
         display.print(xyBiasX, 1);
+        if (menuIndex == 1)
+        {
+            display.print(" <-");
+        }
         display.setCursor(0, 24);
         display.print("Bias Y: ");
         display.print(xyBiasY, 1);
+        if (menuIndex == 2)
+        {
+            display.print(" <-");
+        }
+        display.setCursor(0, 32);
+        display.print("Persistence: ");
+        display.print(xyPersistence ? "On" : "Off");
+        if (menuIndex == 3)
+        {
+            display.print(" <-");
+        }
     }
     else if (currentMenu == RIPPLE_DISPLAY)
     {
@@ -302,122 +438,288 @@ void drawMenu()
     {
         display.print("Oscilloscope:");
     }
-    display.display();
+    else if (currentMenu == SPECTRUM_DISPLAY)
+    {
+        display.print("Spectrum:");
+    }
+    presentDisplay();
 }
 
 void drawParticles()
 {
     display.clearDisplay();
+    uint8_t *frame = display.getBuffer();
 
     for (int i = 0; i < MAX_PARTICLES; ++i)
     {
-        // Update particle position
-        particles[i].x += particles[i].dx * harmonicAmplitudes[i % 7] * 2;
-        particles[i].y += particles[i].dy * harmonicAmplitudes[i % 7] * 2;
+        Particle &particle = particles[i];
+
+        // Each particle moves at up to two pixels a frame, scaled by the amplitude of its harmonic
+        int32_t speed = (int32_t)(harmonicAmplitudes[i % numPartials] * (2 * EFFECT_ONE));
+        particle.x += particle.dx * speed;
+        particle.y += particle.dy * speed;
 
-        // Bounce off edges
-        if (particles[i].x < 0 || particles[i].x >= 128)
-            particles[i].dx = -particles[i].dx;
-        if (particles[i].y < 0 || particles[i].y >= 64)
-            particles[i].dy = -particles[i].dy;
+        // Bounce off edges, folding back inside so a fast particle cannot stick beyond one
+        if (particle.x < 0 || particle.x >= OLED_WIDTH * EFFECT_ONE)
+        {
+            particle.dx = -particle.dx;
+            particle.x = particle.x < 0 ? -particle.x : 2 * (OLED_WIDTH * EFFECT_ONE - 1) - particle.x;
+        }
+        if (particle.y < 0 || particle.y >= OLED_HEIGHT * EFFECT_ONE)
+        {
+            particle.dy = -particle.dy;
+            particle.y = particle.y < 0 ? -particle.y : 2 * (OLED_HEIGHT * EFFECT_ONE - 1) - particle.y;
+        }
 
-        // Draw particle
-        display.drawPixel(particles[i].x, particles[i].y, particles[i].color);
+        plotPixel(frame, particle.x / EFFECT_ONE, particle.y / EFFECT_ONE);
     }
-    display.display();
+    presentDisplay();
 }
 
+// Plot the captured left and right outputs against each other. Points go straight into a 1-bit
+// buffer laid out like the framebuffer. With persistence on they accumulate, and each frame clears
+// one of XY_DECAY_PHASES interleaved sets of bytes, so a point that is not redrawn fades within that
+// many frames; without it only the newest XY_POINTS frames are shown.
 void drawXYOscilloscope()
 {
-    display.clearDisplay();
-
-    float x_signal[numSamples];
-    float y_signal[numSamples];
+    uint32_t count = captureCount();
+    uint32_t fresh = count - xyLastCount;
+    xyLastCount = count;
 
-    for (int i = 0; i < numSamples; ++i)
+    int points = fresh < CAPTURE_HISTORY ? (int)fresh : CAPTURE_HISTORY;
+    if (xyPersistence)
     {
-        x_signal[i] = sin(2.0 * PI * i / numSamples);
-        y_signal[i] = cos(2.0 * PI * i / numSamples);
+        uint8_t *bytes = &xyBuffer[0][0];
+        for (int i = xyDecayPhase; i < (int)sizeof(xyBuffer); i += XY_DECAY_PHASES)
+        {
+            bytes[i] = 0;
+        }
+        xyDecayPhase = (xyDecayPhase + 1) % XY_DECAY_PHASES;
+    }
+    else
+    {
+        memset(xyBuffer, 0, sizeof(xyBuffer));
+        points = XY_POINTS;
     }
 
-    for (int i = 0; i < numSamples; ++i)
+    int32_t biasX = (int32_t)(xyBiasX * 32767.0f);
+    int32_t biasY = (int32_t)(xyBiasY * 32767.0f);
+    for (int age = 0; age < points; ++age)
     {
-        int x = (x_signal[i] + xyBiasX) * (128 / 2) + (128 / 2);
-        int y = (y_signal[i] + xyBiasY) * (64 / 2) + (64 / 2);
+        const CaptureFrame &frame = capturedFrame(age);
+        int32_t sampleX = xySwapped ? frame.right : frame.left;
+        int32_t sampleY = xySwapped ? frame.left : frame.right;
+
+        // Full scale spans the screen in both directions, positive Y upwards
+        int x = OLED_WIDTH / 2 + (((sampleX + biasX) * (OLED_WIDTH / 2)) >> 15);
+        int y = OLED_HEIGHT / 2 - (((sampleY + biasY) * (OLED_HEIGHT / 2)) >> 15);
+        plotPixel(&xyBuffer[0][0], x, y);
+    }
+
+    memcpy(display.getBuffer(), xyBuffer, sizeof(xyBuffer));
+    presentDisplay();
+}
 
-        if (xySwapped)
+// Midpoint circle outline, integer only. A 1-bit panel cannot dim, so a fading ripple thins out
+// instead: each step of the octant is kept when its ordered-dither threshold is below the density.
+static void drawCircleOutline(uint8_t *frame, int cx, int cy, int radius, int32_t density)
+{
+    int x = radius;
+    int y = 0;
+    int error = 1 - radius;
+
+    for (int step = 0; x >= y; ++step)
+    {
+        if (((step * 151) & (EFFECT_ONE - 1)) < density)
         {
-            int temp = x;
-            x = y;
-            y = temp;
+            plotPixel(frame, cx + x, cy + y);
+            plotPixel(frame, cx - x, cy + y);
+            plotPixel(frame, cx + x, cy - y);
+            plotPixel(frame, cx - x, cy - y);
+            plotPixel(frame, cx + y, cy + x);
+            plotPixel(frame, cx - y, cy + x);
+            plotPixel(frame, cx + y, cy - x);
+            plotPixel(frame, cx - y, cy - x);
         }
 
-        if (x >= 0 && x < 128 && y >= 0 && y < 64)
+        ++y;
+        if (error < 0)
+        {
+            error += 2 * y + 1;
+        }
+        else
         {
-            display.drawPixel(x, y, WHITE);
+            --x;
+            error += 2 * (y - x) + 1;
         }
     }
-
-    display.display();
 }
 
 void drawRippleEffect()
 {
     display.clearDisplay();
+    uint8_t *frame = display.getBuffer();
 
     for (int i = 0; i < MAX_RIPPLES; ++i)
     {
         Ripple &ripple = ripples[i];
 
         ripple.radius += ripple.speed;
-        ripple.life -= 0.05;
+        ripple.life -= EFFECT_ONE / 20; // Twenty frames from birth to gone
 
         if (ripple.life <= 0)
         {
             ripple.radius = 0;
             ripple.x = random(128);
             ripple.y = random(64);
-            ripple.speed = random(1, 5) / 10.0;
-            ripple.amplitude = harmonicAmplitudes[random(7)];
-            ripple.life = 1.0;
+            ripple.speed = (int32_t)random(1, 5) * EFFECT_ONE / 10;
+            ripple.life = EFFECT_ONE;
         }
 
-        for (int angle = 0; angle < 360; ++angle)
+        drawCircleOutline(frame, ripple.x, ripple.y, ripple.radius / EFFECT_ONE, ripple.life);
+    }
+
+    presentDisplay();
+}
+
+// Columns of the last trace kept for matching, every SCOPE_MATCH_STEP-th one
+static int16_t lastTrace[SCOPE_WIDTH / SCOPE_MATCH_STEP];
+static bool lastTraceValid = false;
+
+// How far the trace starting at an age is from the last one drawn
+static int32_t traceDistance(int start)
+{
+    int32_t distance = 0;
+    for (int k = 0; k < SCOPE_WIDTH / SCOPE_MATCH_STEP; ++k)
+    {
+        int32_t difference = capturedFrame(start - k * SCOPE_MATCH_STEP).stereo - lastTrace[k];
+        distance += difference < 0 ? -difference : difference;
+    }
+    return distance;
+}
+
+// Pick the trigger point as an age into the capture history, or -1 to free-run. Candidates are the
+// rising crossings of the stereo output's midpoint that still have a full screen of frames after
+// them, each armed by a drop a quarter of the span below the midpoint so noise cannot retrigger.
+// A rich waveform crosses more than once per cycle, so of those the one matching the last trace
+// best wins, newest first on a tie, which keeps every frame on the same point of the cycle.
+static int findTrigger()
+{
+    int low = 32767;
+    int high = -32767;
+    for (int age = 0; age < CAPTURE_HISTORY; ++age)
+    {
+        int level = capturedFrame(age).stereo;
+        low = level < low ? level : low;
+        high = level > high ? level : high;
+    }
+    if (high - low < SCOPE_MIN_SPAN)
+    {
+        lastTraceValid = false;
+        return -1;
+    }
+
+    int middle = (high + low) / 2;
+    int armLevel = middle - (high - low) / 4;
+    int trigger = -1;
+    int32_t bestDistance = INT32_MAX;
+    bool armed = false;
+    for (int age = CAPTURE_HISTORY - 1; age >= SCOPE_WIDTH - 1; --age)
+    {
+        int level = capturedFrame(age).stereo;
+        if (level < armLevel)
         {
-            float rad = radians(angle);
-            int x = int(ripple.x + ripple.radius * cos(rad));
-            int y = int(ripple.y + ripple.radius * sin(rad));
-            if (x >= 0 && x < 128 && y >= 0 && y < 64)
+            armed = true;
+        }
+        else if (armed && level >= middle)
+        {
+            armed = false;
+            int32_t distance = lastTraceValid ? traceDistance(age) : 0;
+            if (distance <= bestDistance)
             {
-                display.drawPixel(x, y, WHITE * ripple.life);
+                bestDistance = distance;
+                trigger = age;
             }
         }
     }
 
-    display.display();
+    if (trigger >= 0)
+    {
+        for (int k = 0; k < SCOPE_WIDTH / SCOPE_MATCH_STEP; ++k)
+        {
+            lastTrace[k] = capturedFrame(trigger - k * SCOPE_MATCH_STEP).stereo;
+        }
+    }
+    lastTraceValid = trigger >= 0;
+    return trigger;
 }
 
+// Plot the captured output, triggered for a stable trace and free-running when there is no crossing
 void drawWaveformOscilloscope()
 {
     display.clearDisplay();
 
-    for (int x = 0; x < 128; ++x)
+    int trigger = findTrigger();
+    int start = trigger >= 0 ? trigger : SCOPE_WIDTH - 1;
+
+    int lastY = 0;
+    for (int x = 0; x < SCOPE_WIDTH; ++x)
     {
-        float sample = 0.0;
-        for (int i = 0; i < 7; ++i)
-        {
-            sample += harmonicAmplitudes[i] * sin(2.0 * PI * (i + 1) * x / 128.0);
-        }
-        int y = 32 + (int)(sample * 16); // Center at 32, scale to 16 pixels
-        display.drawPixel(x, y, WHITE);
+        int y = 32 - ((capturedFrame(start - x).stereo * 31) >> 15); // Full scale spans the screen
+        if (x > 0)
+            display.drawLine(x - 1, lastY, x, y, WHITE);
+        lastY = y;
     }
 
-    display.display();
+    presentDisplay();
+}
+
+void drawSpectrum()
+{
+    stepAnalyzer();
+
+    display.clearDisplay();
+    display.setCursor(0, 0);
+    display.print("Spectrum");
+
+    // Ticks under the title at 100 Hz and 1 kHz, the second clear of the title for a label
+    display.drawFastVLine(analyzerColumn(100.0f), 8, 2, WHITE);
+    int kilohertz = analyzerColumn(1000.0f);
+    display.drawFastVLine(kilohertz, 8, 2, WHITE);
+    display.setCursor(kilohertz + 2, 0);
+    display.print("1k");
+
+    // Bars fill the rows below the ticks
+    const int top = 11;
+    uint8_t bars[ANALYZER_BARS];
+    analyzerBars(bars, 64 - top);
+    for (int x = 0; x < ANALYZER_BARS; ++x)
+    {
+        if (bars[x] > 0)
+            display.drawFastVLine(x, 64 - bars[x], bars[x], WHITE);
+    }
+
+    presentDisplay();
+}
+
+void drawVisualsPaused()
+{
+    display.clearDisplay();
+    display.setCursor(0, 16);
+    display.print("Visuals paused");
+    display.setCursor(0, 32);
+    display.print("Audio needs the CPU");
+    display.setCursor(0, 48);
+    display.print("Partials: ");
+    display.print(partialLimit());
+    display.print("/");
+    display.print(numPartials);
+    presentDisplay();
 }
 
 // Function to draw the bitmap on the display
 void drawBitmap(const unsigned char *bitmap, uint8_t w, uint8_t h) {
     display.clearDisplay();
     display.drawBitmap((display.width() - w) / 2, (display.height() - h) / 2, bitmap, w, h, SSD1305_YELLOW);
-    display.display();
+    presentDisplay();
 }
@@ -31,19 +31,46 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1305.h>
 
-// Define the display address and reset pin
+// Define the display reset pin, the address is OLED_I2C_ADDRESS in oled.h
 #define OLED_RESET 4
-#define OLED_ADDRESS 0x3D
+
+// Menu and view pages, in the order the encoder steps through them
+enum MenuMode
+{
+    SCALE_MENU,
+    FREQUENCY_MENU,
+    HARMONIC_MENU,
+    MODULATION_MENU,
+    PANNING_MENU,
+    CV_MENU,
+    AMPLITUDE_MENU,
+    WAVEFORM_MENU,
+    PARTICLE_DISPLAY,
+    XY_DISPLAY,
+    RIPPLE_DISPLAY,
+    OSCILLOSCOPE_DISPLAY,
+    SPECTRUM_DISPLAY,
+    DEFAULT_VIEW
+};
 
 // Create SSD1305 display instance
 extern Adafruit_SSD1305 display;
 
-void initDisplay();
+extern const float baseFrequencies[];
+
+void initDisplay(); // Brings up the panel and its flush task and shows the splash, run from the UI task
+void initEffects();
+void drawPopupMenu(int index);
+bool handlePopupSelection(int index); // Returns true to keep the popup open
+void drawWaveforms();
 void drawAmplitudeBars();
 void drawMenu();
 void drawParticles();
 void drawXYOscilloscope();
 void drawRippleEffect();
 void drawWaveformOscilloscope();
+void drawSpectrum(); // Advances the running transform, then draws the latest bars
+void drawVisualsPaused(); // Stands in for a visualizer the CPU governor has paused
+void drawBitmap(const unsigned char *bitmap, uint8_t w, uint8_t h);
 
 #endif
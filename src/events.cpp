@@ -0,0 +1,133 @@
+/*
+ * File: events.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#include "events.h"
+#include "platform.h"
+#include "ring.h"
+#include <atomic>
+
+static SpscRing<ControlEvent, EVENT_QUEUE_SIZE> eventQueue;
+
+// The consumer moves queued events in here by frame, latest first so the next due sits at the end.
+// Events on the same frame keep the order they were posted in.
+static ControlEvent scheduled[EVENT_SCHEDULE_SIZE];
+static int scheduledCount = 0;
+
+// Events the engine has applied, on their way to the UI. The engine keeps a copy of as many as the
+// queue holds, which covers every one the UI has yet to take.
+static SpscRing<ControlEvent, EVENT_QUEUE_SIZE> appliedQueue;
+static ControlEvent appliedHistory[EVENT_QUEUE_SIZE];
+static uint32_t appliedCount = 0; // Engine side
+static uint32_t takenCount = 0;   // UI side
+
+// Frame and time of the last block start, under a sequence counter that is odd while they change
+static std::atomic<uint32_t> clockSequence(0);
+static uint32_t clockFrame = 0;
+static int64_t clockMicros = 0;
+
+bool postEvent(const ControlEvent &event)
+{
+    return eventQueue.push(event);
+}
+
+void IRAM_ATTR markRenderClock(uint32_t frame, int64_t micros)
+{
+    uint32_t sequence = clockSequence.load(std::memory_order_relaxed);
+    clockSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    clockFrame = frame;
+    clockMicros = micros;
+    clockSequence.store(sequence + 2, std::memory_order_release);
+}
+
+uint32_t frameAt(int64_t micros)
+{
+    for (;;)
+    {
+        uint32_t sequence = clockSequence.load(std::memory_order_acquire);
+        uint32_t frame = clockFrame;
+        int64_t since = micros - clockMicros;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((sequence & 1) == 0 && clockSequence.load(std::memory_order_relaxed) == sequence)
+            return frame + (uint32_t)(int32_t)(since * AUDIO_SAMPLE_RATE / 1000000);
+    }
+}
+
+static void IRAM_ATTR schedule(const ControlEvent &event)
+{
+    int i = scheduledCount++;
+    while (i > 0 && (int32_t)(scheduled[i - 1].frame - event.frame) < 0)
+    {
+        scheduled[i] = scheduled[i - 1];
+        --i;
+    }
+    scheduled[i] = event;
+}
+
+bool IRAM_ATTR peekEvent(ControlEvent &event)
+{
+    ControlEvent queued;
+    while (scheduledCount < EVENT_SCHEDULE_SIZE && eventQueue.pop(queued))
+    {
+        schedule(queued);
+    }
+    if (scheduledCount == 0)
+        return false;
+    event = scheduled[scheduledCount - 1];
+    return true;
+}
+
+void IRAM_ATTR dropEvent(const ControlEvent &applied)
+{
+    if (scheduledCount == 0)
+        return;
+    --scheduledCount;
+    if (appliedQueue.push(applied))
+        appliedHistory[appliedCount++ & (EVENT_QUEUE_SIZE - 1)] = applied;
+}
+
+bool IRAM_ATTR appliedEventAfter(uint32_t &sequence, ControlEvent &event)
+{
+    if ((int32_t)(appliedCount - sequence) <= 0)
+        return false;
+    event = appliedHistory[sequence++ & (EVENT_QUEUE_SIZE - 1)];
+    return true;
+}
+
+bool nextAppliedEvent(ControlEvent &event)
+{
+    if (!appliedQueue.pop(event))
+        return false;
+    ++takenCount;
+    return true;
+}
+
+uint32_t appliedEventsTaken()
+{
+    return takenCount;
+}
@@ -0,0 +1,86 @@
+/*
+ * File: events.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+#include "synth.h"
+
+// Timestamped settings changes for the engine. The control inputs stamp each change with the frame
+// it should sound on and queue it, the renderer applies it at that exact frame of whichever block it
+// falls in. Changes the UI makes still go through the published snapshot between blocks.
+#define EVENT_QUEUE_SIZE 64    // A power of two
+#define EVENT_SCHEDULE_SIZE 64 // Events the engine holds sorted by frame, more wait in the queue
+
+// Delay from a change arriving to the frame it is stamped for. Two blocks always land past the block
+// rendering when it arrived, so every change keeps the same latency and none is ever late.
+#define EVENT_LATENCY_FRAMES (2 * AUDIO_BLOCK_SIZE)
+
+enum ControlEventType
+{
+    EVENT_FREQUENCY, // value is the base frequency in Hz
+    EVENT_AMPLITUDE, // source is the harmonic from 0, value its amplitude
+    EVENT_MATRIX     // source and target harmonics from 0, value the modulation amount
+};
+
+struct ControlEvent
+{
+    uint32_t frame; // On the renderedFrames() clock
+    uint8_t type;
+    uint8_t source;
+    uint8_t target;
+    float value;
+};
+
+// Producer side, a single task. Never blocks: returns false and drops the event when the queue is
+// full. Events apply in frame order whatever order they were posted in, so one scheduled far ahead
+// holds back nothing behind it. Events on the same frame apply in the order they were posted.
+bool postEvent(const ControlEvent &event);
+
+// Audio side, once per block before rendering: the frame the block starts on and the time it started
+void markRenderClock(uint32_t frame, int64_t micros);
+
+// Any task: the frame rendering at a time on the same clock, extrapolated from the last mark
+uint32_t frameAt(int64_t micros);
+
+// Engine side, single consumer: the earliest event without removing it, false when none is queued
+bool peekEvent(ControlEvent &event);
+// Removes the event peekEvent() returned once it is applied, and passes it to the UI as applied
+void dropEvent(const ControlEvent &applied);
+
+// Engine side: step sequence through the applied events, false once past the newest. A snapshot
+// published before the UI took some in would undo them, the engine plays those again on top of it.
+bool appliedEventAfter(uint32_t &sequence, ControlEvent &event);
+
+// UI side, single consumer: the next event the engine applied, for the UI to show and keep in the
+// settings it publishes, and how many it has taken so far, for SynthParams::eventsTaken
+bool nextAppliedEvent(ControlEvent &event);
+uint32_t appliedEventsTaken();
+
+#endif
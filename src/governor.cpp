@@ -0,0 +1,121 @@
+/*
+ * File: governor.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "governor.h"
+#include "audio.h"
+#include "synth.h"
+#include "ui.h"
+#include <Arduino.h>
+
+// Past GOVERNOR_NO_VISUALS every level takes GOVERNOR_PARTIAL_STEP more partials away
+static const int partialLevels =
+    numPartials > GOVERNOR_MIN_PARTIALS ? (numPartials - GOVERNOR_MIN_PARTIALS + GOVERNOR_PARTIAL_STEP - 1) / GOVERNOR_PARTIAL_STEP : 0;
+static const int maxLevel = GOVERNOR_NO_VISUALS + partialLevels;
+
+static int level = GOVERNOR_FULL;
+static uint32_t lastStepAt = 0;
+static uint32_t calmSince = 0;
+static uint32_t seenOverruns = 0;
+static uint32_t lastOverrunAt = 0;
+static bool overranRecently = false;
+
+static void applyLevel()
+{
+    int limit = numPartials;
+    if (level >= GOVERNOR_CAP_PARTIALS)
+    {
+        limit = numPartials - (level - GOVERNOR_NO_VISUALS) * GOVERNOR_PARTIAL_STEP;
+        limit = limit < GOVERNOR_MIN_PARTIALS ? GOVERNOR_MIN_PARTIALS : limit;
+    }
+    setPartialLimit(limit);
+}
+
+bool pollGovernor()
+{
+    uint32_t now = millis();
+    uint32_t load = getAudioLoad();
+
+    // An overrun counts as strain for one step interval, long enough for the next step to fall due
+    uint32_t overruns = getAudioOverruns();
+    if (overruns != seenOverruns)
+    {
+        seenOverruns = overruns;
+        lastOverrunAt = now;
+        overranRecently = true;
+    }
+    else if (overranRecently && now - lastOverrunAt >= GOVERNOR_STEP_MS)
+    {
+        overranRecently = false;
+    }
+    bool strained = load > GOVERNOR_HIGH_LOAD || overranRecently;
+
+    if (strained)
+    {
+        calmSince = now;
+        if (level < maxLevel && now - lastStepAt >= GOVERNOR_STEP_MS)
+        {
+            ++level;
+            lastStepAt = now;
+            overranRecently = false; // The step gets its own interval to show whether it was enough
+            applyLevel();
+            return true;
+        }
+        return false;
+    }
+
+    // Somewhere between the thresholds holds the level where it is
+    if (load > GOVERNOR_LOW_LOAD)
+    {
+        calmSince = now;
+        return false;
+    }
+
+    if (level > GOVERNOR_FULL && now - calmSince >= GOVERNOR_RECOVER_MS)
+    {
+        --level;
+        lastStepAt = now;
+        calmSince = now;
+        applyLevel();
+        return true;
+    }
+    return false;
+}
+
+int governorLevel()
+{
+    return level;
+}
+
+int governorFrameRate()
+{
+    return level >= GOVERNOR_SLOW_DISPLAY ? GOVERNOR_SLOW_FRAME_RATE : UI_FRAME_RATE;
+}
+
+bool governorVisualsPaused()
+{
+    return level >= GOVERNOR_NO_VISUALS;
+}
@@ -0,0 +1,59 @@
+/*
+ * File: governor.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <stdint.h>
+
+// Keeps audio ahead of everything else. While the renderer's load stays above GOVERNOR_HIGH_LOAD or
+// blocks overrun, the governor steps down one level at a time, each given GOVERNOR_STEP_MS to take
+// effect; once load has stayed under GOVERNOR_LOW_LOAD for GOVERNOR_RECOVER_MS it steps back up.
+#define GOVERNOR_HIGH_LOAD 85 // Audio load, in percent
+#define GOVERNOR_LOW_LOAD 60
+#define GOVERNOR_STEP_MS 500
+#define GOVERNOR_RECOVER_MS 5000
+#define GOVERNOR_SLOW_FRAME_RATE 10
+#define GOVERNOR_MIN_PARTIALS 8
+#define GOVERNOR_PARTIAL_STEP ((numPartials + 3) / 4) // Partials dropped per level past GOVERNOR_CAP_PARTIALS
+
+// Levels in the order they are given up, every level keeps the savings of those before it
+enum GovernorLevel
+{
+    GOVERNOR_FULL,
+    GOVERNOR_SLOW_DISPLAY, // The UI redraws at GOVERNOR_SLOW_FRAME_RATE
+    GOVERNOR_NO_VISUALS,   // The particle and ripple views pause
+    GOVERNOR_CAP_PARTIALS  // The highest partials fade out, and again at each level above
+};
+
+// Run from the UI task on every wake, returns true when the level changed
+bool pollGovernor();
+int governorLevel();
+int governorFrameRate();
+bool governorVisualsPaused();
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * File: input.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#include "input.h"
+#include <Arduino.h>
+#include <driver/pcnt.h>
+#include <esp_timer.h>
+#include <freertos/queue.h>
+
+#define ENCODER_PCNT_UNIT PCNT_UNIT_0
+
+static QueueHandle_t inputQueue = NULL;
+
+static void IRAM_ATTR queueEvent(uint8_t type, int8_t value)
+{
+    InputEvent event;
+    event.time = (uint32_t)esp_timer_get_time();
+    event.type = type;
+    event.value = value;
+
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xQueueSendFromISR(inputQueue, &event, &higherPriorityTaskWoken); // A full queue drops the event
+    if (higherPriorityTaskWoken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// The counter runs between -4 and 4 and clears itself at either limit, one interrupt per detent
+static void IRAM_ATTR onEncoderLimit(void *arg)
+{
+    uint32_t status = 0;
+    pcnt_get_event_status(ENCODER_PCNT_UNIT, &status);
+    if (status & PCNT_EVT_H_LIM)
+        queueEvent(INPUT_TURN, 1);
+    else if (status & PCNT_EVT_L_LIM)
+        queueEvent(INPUT_TURN, -1);
+}
+
+static void IRAM_ATTR onButtonEdge()
+{
+    queueEvent(INPUT_BUTTON, (int8_t)digitalRead(ENCODER_BUTTON_PIN));
+}
+
+// Full quadrature decoding on two channels, each counting the edges of one pin with the other
+// setting the direction. The signs match the RotaryEncoder library this replaces.
+static void configureEncoderChannel(pcnt_channel_t channel, int pulsePin, int controlPin, pcnt_ctrl_mode_t lowMode,
+                                    pcnt_ctrl_mode_t highMode)
+{
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = pulsePin;
+    config.ctrl_gpio_num = controlPin;
+    config.channel = channel;
+    config.unit = ENCODER_PCNT_UNIT;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    config.lctrl_mode = lowMode;
+    config.hctrl_mode = highMode;
+    config.counter_h_lim = ENCODER_STEPS_PER_DETENT;
+    config.counter_l_lim = -ENCODER_STEPS_PER_DETENT;
+    pcnt_unit_config(&config);
+}
+
+void initInput()
+{
+    inputQueue = xQueueCreate(INPUT_QUEUE_LENGTH, sizeof(InputEvent));
+
+    pinMode(ENCODER_PIN_A, INPUT_PULLUP);
+    pinMode(ENCODER_PIN_B, INPUT_PULLUP);
+    pinMode(ENCODER_BUTTON_PIN, INPUT_PULLUP);
+
+    configureEncoderChannel(PCNT_CHANNEL_0, ENCODER_PIN_A, ENCODER_PIN_B, PCNT_MODE_REVERSE, PCNT_MODE_KEEP);
+    configureEncoderChannel(PCNT_CHANNEL_1, ENCODER_PIN_B, ENCODER_PIN_A, PCNT_MODE_KEEP, PCNT_MODE_REVERSE);
+
+    pcnt_set_filter_value(ENCODER_PCNT_UNIT, ENCODER_FILTER_CYCLES);
+    pcnt_filter_enable(ENCODER_PCNT_UNIT);
+    pcnt_event_enable(ENCODER_PCNT_UNIT, PCNT_EVT_H_LIM);
+    pcnt_event_enable(ENCODER_PCNT_UNIT, PCNT_EVT_L_LIM);
+
+    // Start counting from the detent the knob rests on
+    pcnt_counter_pause(ENCODER_PCNT_UNIT);
+    pcnt_counter_clear(ENCODER_PCNT_UNIT);
+    pcnt_isr_service_install(0);
+    pcnt_isr_handler_add(ENCODER_PCNT_UNIT, onEncoderLimit, NULL);
+    pcnt_counter_resume(ENCODER_PCNT_UNIT);
+
+    attachInterrupt(ENCODER_BUTTON_PIN, onButtonEdge, CHANGE);
+}
+
+bool nextInputEvent(InputEvent &event, uint32_t timeoutTicks)
+{
+    return xQueueReceive(inputQueue, &event, timeoutTicks) == pdTRUE;
+}
+
+uint32_t inputTime()
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+bool buttonDown()
+{
+    return digitalRead(ENCODER_BUTTON_PIN) == LOW;
+}
@@ -0,0 +1,66 @@
+/*
+ * File: input.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdint.h>
+
+// Define the rotary encoder pins
+#define ENCODER_PIN_A 32
+#define ENCODER_PIN_B 33
+#define ENCODER_BUTTON_PIN 27 // Needs the internal pull-up, GPIO34 to 39 have none and carry the CV inputs
+
+// The encoder is decoded in hardware by a pulse counter unit, so detents are never lost however
+// long the UI takes over a frame. The counter sees every quadrature edge, four per detent.
+#define ENCODER_STEPS_PER_DETENT 4
+#define ENCODER_FILTER_CYCLES 1023 // Glitch filter on both encoder pins, in 80 MHz APB cycles (12.8 us)
+#define INPUT_QUEUE_LENGTH 32
+
+enum InputEventType
+{
+    INPUT_TURN,  // value is +1 or -1 detents
+    INPUT_BUTTON // value is the pin level after the edge, LOW while pressed; edges are not debounced
+};
+
+struct InputEvent
+{
+    uint32_t time; // Microseconds since boot, wraps after about 71 minutes
+    uint8_t type;
+    int8_t value;
+};
+
+void initInput(); // Run from the UI task, the interrupts land on the core that calls it
+
+// Wait at most timeoutTicks for the next event, returns false when none arrived
+bool nextInputEvent(InputEvent &event, uint32_t timeoutTicks);
+
+uint32_t inputTime(); // The clock events are stamped with
+bool buttonDown();
+
+#endif
@@ -30,253 +30,97 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <Adafruit_MCP4725.h>
-#include <RotaryEncoder.h>
 #include "display.h"
 #include "dac.h"
-#include "bitmap.h"
-
-// Define the rotary encoder pins
-#define ENCODER_PIN_A 32
-#define ENCODER_PIN_B 33
-#define ENCODER_BUTTON_PIN 34
-
-// Define the ADC input pins for CV
-#define CV_PIN_1 34
-#define CV_PIN_2 35
-#define CV_PIN_3 36
-#define CV_PIN_4 39
-
-// Create rotary encoder instance
-RotaryEncoder encoder(ENCODER_PIN_A, ENCODER_PIN_B, RotaryEncoder::LatchMode::FOUR3);
+#include "audio.h"
+#include "cv.h"
+#include "synth.h"
+#include "params.h"
+#include "pitch.h"
+#include "ui.h"
+#include "wavetable.h"
+#include "profile.h"
+#include "presets.h"
+#include "control.h"
 
 // Harmonic control variables
 int harmonicIndex = 0;
-float harmonicAmplitudes[7] = {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
-float harmonicPanning[7] = {0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5}; // 0.0 is full left, 1.0 is full right
+float harmonicAmplitudes[numPartials] = {1.0};
+float harmonicPanning[numPartials]; // 0.0 is full left, 1.0 is full right, centred in setup()
 float baseFrequency = 440.0;									// Base frequency set to A4 (440 Hz)
 int baseFrequencyIndex = 1;										// Default to 440 Hz
 
-// Timer for the sine wave generation
-hw_timer_t *timer = NULL;
-portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
-
-// Waveform parameters
-const int sampleRate = 1000; // Adjust as needed
-const int numSamples = 256;
-int sampleIndex = 0;
-
-// Sine wave table
-float sineTable[numSamples];
-
 // Menu and scale settings
-enum MenuMode
-{
-	SCALE_MENU,
-	FREQUENCY_MENU,
-	HARMONIC_MENU,
-	MODULATION_MENU,
-	PANNING_MENU,
-	CV_MENU,
-	AMPLITUDE_MENU,
-	WAVEFORM_MENU,
-	PARTICLE_DISPLAY,
-	XY_DISPLAY,
-	RIPPLE_DISPLAY,
-	OSCILLOSCOPE_DISPLAY,
-	DEFAULT_VIEW
-};
 MenuMode currentMenu = DEFAULT_VIEW;
 int menuIndex = 0;
 bool inMenu = false;
 bool inPopupMenu = false;
+int scaleIndex = 0; // Into scales[], 0 keeps the harmonic series
 
-const char *scaleNames[] = {"Major", "Minor", "Natural Harmonic", "Pentatonic"};
 const float baseFrequencies[] = {220.0, 440.0, 880.0, 1760.0};
 const char *waveformNames[] = {"Sine", "Saw", "Triangle", "Pulse"};
 
 // Modulation matrix
-float modulationMatrix[7][7] = {0}; // 7 harmonics modulating each other
+float modulationMatrix[numPartials][numPartials] = {0}; // Every partial modulating each other
 
 // CV input assignments
-enum CVMode
-{
-	NONE,
-	LIN_FM,
-	EXP_FM,
-	AMPLITUDE,
-	PITCH_1V_OCT
-};
 CVMode cvAssignments[4] = {NONE, NONE, NONE, NONE};
 
 // Base waveform type
-enum WaveformType
-{
-	SINE,
-	SAW,
-	TRIANGLE,
-	PULSE
-};
 WaveformType currentWaveform = SINE;
 
 // XY Oscilloscope settings
 bool xySwapped = false;
 float xyBiasX = 0.0;
 float xyBiasY = 0.0;
-
-// Timer interrupt service routine to generate waveforms
-void IRAM_ATTR onTimer()
-{
-	portENTER_CRITICAL_ISR(&timerMux);
-
-	float leftSample = 0.0;
-	float rightSample = 0.0;
-	float stereoSample = 0.0;
-	float waveSamples[7] = {0.0};
-
-	// Read CV inputs
-	float cvValues[4];
-	cvValues[0] = analogRead(CV_PIN_1) / 4095.0;
-	cvValues[1] = analogRead(CV_PIN_2) / 4095.0;
-	cvValues[2] = analogRead(CV_PIN_3) / 4095.0;
-	cvValues[3] = analogRead(CV_PIN_4) / 4095.0;
-
-	// Calculate the sample value for each harmonic
-	for (int i = 0; i < 7; ++i)
-	{
-		// Apply modulation from other harmonics
-		float modulatedFrequency = baseFrequency * (i + 1);
-		for (int j = 0; j < 7; ++j)
-		{
-			modulatedFrequency += modulationMatrix[j][i] * harmonicAmplitudes[j];
-		}
-
-		// Apply CV inputs
-		for (int cvIndex = 0; cvIndex < 4; ++cvIndex)
-		{
-			switch (cvAssignments[cvIndex])
-			{
-			case LIN_FM:
-				modulatedFrequency += cvValues[cvIndex] * baseFrequency;
-				break;
-			case EXP_FM:
-				modulatedFrequency *= pow(2, cvValues[cvIndex]);
-				break;
-			case AMPLITUDE:
-				harmonicAmplitudes[i] *= cvValues[cvIndex];
-				break;
-			case PITCH_1V_OCT:
-				modulatedFrequency *= pow(2, cvValues[cvIndex] - 1); // Assuming 1V/oct
-				break;
-			case NONE:
-			default:
-				break;
-			}
-		}
-
-		// Generate the base waveform sample
-		float harmonicSample;
-		switch (currentWaveform)
-		{
-		case SINE:
-			harmonicSample = harmonicAmplitudes[i] * sin(2.0 * PI * (sampleIndex * modulatedFrequency / sampleRate));
-			break;
-		case SAW:
-			harmonicSample = harmonicAmplitudes[i] * (2.0 * (float)(sampleIndex % numSamples) / numSamples - 1.0);
-			break;
-		case TRIANGLE:
-			harmonicSample = harmonicAmplitudes[i] * (2.0 * abs(2.0 * (float)(sampleIndex % numSamples) / numSamples - 1.0) - 1.0);
-			break;
-		case PULSE:
-			harmonicSample = harmonicAmplitudes[i] * ((sampleIndex % numSamples) < (numSamples / 2) ? 1.0 : -1.0);
-			break;
-		}
-
-		float pan = harmonicPanning[i];
-		leftSample += harmonicSample * (1.0 - pan);
-		rightSample += harmonicSample * pan;
-		stereoSample += harmonicSample;	 // Mixed for stereo output
-		waveSamples[i] = harmonicSample; // Individual wave output
-	}
-
-	// Output the sample values to the DACs
-	outputToDACs(leftSample, rightSample, stereoSample, waveSamples);
-
-	// Increment the sample index
-	sampleIndex = (sampleIndex + 1) % numSamples;
-	portEXIT_CRITICAL_ISR(&timerMux);
-}
-
+bool xyPersistence = false;
+
+// Runtime layout: core 1 runs the audio renderer at the highest priority with the DAC bus tasks just
+// below it, core 0 runs the MIDI and serial control parser, the CV sampler, the UI task and the
+// display flush task beneath it, so slow display frames never touch audio.
+//
+// Boot brings sound up first: nothing ahead of initAudio() waits on the display, and the sine and
+// exp2 tables are already in flash, so after a power blip the module plays the last saved preset
+// within a few tens of milliseconds. The display comes up and shows the splash afterwards, on the UI
+// task.
 void setup()
 {
 	Serial.begin(115200);
+	initProfiler();
 
 	// Initialize the DACs
 	initDACs();
 
-	// Initialize the display
-    display.begin(SSD1305_SWITCHCAPVCC, 0x3C);
-    display.display();
-    delay(1000); // Pause for 1 second
-    display.clearDisplay();
+	// Build the band-limited tables for the other waveforms
+	initWavetables();
+
+	// Load the default pitch calibration, the sine and exp2 tables are already in flash
+	initPitch();
 
-	// Display the loading screen
-    drawBitmap(epd_bitmap_stone_eye, 67, 67);
-    delay(3000); // Show the loading screen for 3 seconds
+	// Start sampling the CV inputs
+	initCV();
 
-	// Generate the sine wave table
-	for (int i = 0; i < numSamples; ++i)
+	// Start rendering audio from the last saved preset, or the initial settings on a fresh module
+	for (int i = 0; i < numPartials; ++i)
 	{
-		sineTable[i] = sin(2.0 * PI * i / numSamples);
+		harmonicPanning[i] = 0.5;
 	}
+	initPresets();
+	if (!restoreLastPreset())
+	{
+		publishSettings();
+	}
+	initAudio();
 
-	// Initialize the rotary encoder
-	encoder.begin();
-	pinMode(ENCODER_BUTTON_PIN, INPUT_PULLUP);
-
-	// Initialize CV input pins
-	pinMode(CV_PIN_1, INPUT);
-	pinMode(CV_PIN_2, INPUT);
-	pinMode(CV_PIN_3, INPUT);
-	pinMode(CV_PIN_4, INPUT);
+	// Take MIDI and the serial protocol, stamped against the running audio clock
+	initControl();
 
-	// Set up the timer interrupt for sine wave generation
-	timer = timerBegin(0, 80, true); // Timer 0, prescaler 80, count up
-	timerAttachInterrupt(timer, &onTimer, true);
-	timerAlarmWrite(timer, 1000000 / sampleRate, true); // 1 second / sampleRate
-	timerAlarmEnable(timer);
+	// Hand the encoder and display over to the UI task, which brings up the panel and splash
+	initUI();
 }
 
-// Quantize the harmonics based on the selected musical scale
-void quantizeHarmonics()
+// Everything runs in the tasks started by setup(), release the Arduino loop task
+void loop()
 {
-	// Define the scales as arrays of frequency ratios
-	float majorScale[] = {1.0, 1.122, 1.26, 1.335, 1.5, 1.682, 1.888};
-	float minorScale[] = {1.0, 1.122, 1.189, 1.335, 1.5, 1.587, 1.782};
-	float naturalHarmonicScale[] = {1.0, 1.125, 1.25, 1.375, 1.5, 1.625, 1.75};
-	float pentatonicScale[] = {1.0, 1.125, 1.25, 1.5, 1.75, 2.0, 2.25};
-
-	float *selectedScale;
-
-	// Select the appropriate scale based on the current menu
-	switch (currentMenu)
-	{
-	case SCALE_MENU:
-		selectedScale = majorScale;
-		break;
-	case MINOR:
-		selectedScale = minorScale;
-		break;
-	case NATURAL_HARMONIC:
-		selectedScale = naturalHarmonicScale;
-		break;
-	case PENTATONIC:
-		selectedScale = pentatonicScale;
-		break;
-	}
-
-	// Apply the selected scale to the harmonic amplitudes
-	for (int i = 0; i < 7; ++i)
-	{
-		harmonicAmplitudes[i] = selectedScale[i];
-	}
+	vTaskDelete(NULL);
 }
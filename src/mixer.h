@@ -0,0 +1,127 @@
+/*
+ * File: mixer.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+#include <string.h>
+#include "synth.h"
+#include "tables.h"
+#include "platform.h"
+
+// Block kernels for the oscillator mix, each streaming through contiguous runs of at most
+// CONTROL_BLOCK_SIZE samples. On the ESP32 the float kernels go through esp-dsp, whose dsps_*
+// entry points resolve to the Xtensa assembly or, on the S3, the PIE vector variants. The integer
+// kernels stay scalar because esp-dsp's s16 routines saturate to 16 bits, and the buses need the
+// headroom above full scale. The kernels here sit in IRAM with the rest of the audio path, but the
+// esp-dsp routines they call are linked from the library's flash text; building with
+// SYNTH_USE_ESP_DSP 0 keeps every instruction of the mix in IRAM.
+#ifndef SYNTH_USE_ESP_DSP
+#if defined(ARDUINO_ARCH_ESP32) && !SYNTH_FIXED_POINT
+#define SYNTH_USE_ESP_DSP 1
+#else
+#define SYNTH_USE_ESP_DSP 0
+#endif
+#endif
+
+#if SYNTH_USE_ESP_DSP
+#include "esp_dsp.h"
+#endif
+
+// Amplitude and pan ramps share the sample format of the audio-rate stage. In fixed point they are
+// Q22, so the per-frame step keeps its resolution and amplitudes up to 2 fit the Q14 multiply.
+#if SYNTH_FIXED_POINT
+typedef int32_t ramp_t;
+#define RAMP_SHIFT 22
+static inline ramp_t toRamp(float value)
+{
+    return (ramp_t)(value * (float)(1 << RAMP_SHIFT));
+}
+#else
+typedef float ramp_t;
+static inline ramp_t toRamp(float value)
+{
+    return value;
+}
+#endif
+
+static inline void IRAM_ATTR mixClear(sample_t *out, int frames)
+{
+    memset(out, 0, sizeof(sample_t) * frames);
+}
+
+// out = in * (start + step * n), the linear ramps updateControl() sets up
+static inline void IRAM_ATTR mixApplyRamp(const sample_t *in, sample_t *out, int frames, ramp_t start, ramp_t step)
+{
+#if SYNTH_USE_ESP_DSP
+    float gain[CONTROL_BLOCK_SIZE];
+    dsps_mulc_f32(rampSteps.values, gain, frames, step, 1, 1);
+    dsps_addc_f32(gain, gain, frames, start, 1, 1);
+    dsps_mul_f32(in, gain, out, frames, 1, 1, 1);
+#elif SYNTH_FIXED_POINT
+    for (int n = 0; n < frames; ++n)
+    {
+        out[n] = (in[n] * (start >> (RAMP_SHIFT - 14))) >> 14; // Q15 times Q14, at most 2^30
+        start += step;
+    }
+#else
+    for (int n = 0; n < frames; ++n)
+    {
+        out[n] = in[n] * start;
+        start += step;
+    }
+#endif
+}
+
+// acc += in
+static inline void IRAM_ATTR mixAdd(sample_t *acc, const sample_t *in, int frames)
+{
+#if SYNTH_USE_ESP_DSP
+    dsps_add_f32(acc, in, acc, frames, 1, 1, 1);
+#else
+    for (int n = 0; n < frames; ++n)
+    {
+        acc[n] += in[n];
+    }
+#endif
+}
+
+// out = a - b
+static inline void IRAM_ATTR mixSubtract(const sample_t *a, const sample_t *b, sample_t *out, int frames)
+{
+#if SYNTH_USE_ESP_DSP
+    dsps_sub_f32(a, b, out, frames, 1, 1, 1);
+#else
+    for (int n = 0; n < frames; ++n)
+    {
+        out[n] = a[n] - b[n];
+    }
+#endif
+}
+
+#endif
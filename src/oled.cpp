@@ -0,0 +1,201 @@
+/*
+ * File: oled.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "oled.h"
+#include "display.h"
+#include "audio.h"
+#include "dac.h"
+#include <Wire.h>
+#include <string.h>
+#include <esp_timer.h>
+#include <freertos/semphr.h>
+
+// SSD1305 page addressing commands
+#define OLED_CONTROL_COMMAND 0x00
+#define OLED_CONTROL_DATA 0x40
+#define OLED_SET_PAGE 0xB0
+#define OLED_SET_COLUMN_LOW 0x00
+#define OLED_SET_COLUMN_HIGH 0x10
+#define OLED_SET_ADDRESSING_MODE 0x20
+#define OLED_PAGE_ADDRESSING 0x02
+
+// The newest presented frame, the one being sent, and what the panel RAM holds right now
+static uint8_t frontFrame[OLED_PAGES][OLED_WIDTH];
+static uint8_t sendingFrame[OLED_PAGES][OLED_WIDTH];
+static uint8_t shownFrame[OLED_PAGES][OLED_WIDTH];
+static bool framePending = false;
+static volatile bool shownValid = false;
+
+static SemaphoreHandle_t frontLock = NULL; // Guards frontFrame and framePending
+static TaskHandle_t flushTaskHandle = NULL;
+
+static void sendRun(int page, int column, const uint8_t *data, int count)
+{
+    int ramColumn = column + OLED_COLUMN_OFFSET;
+
+    Wire.beginTransmission(OLED_I2C_ADDRESS);
+    Wire.write(OLED_CONTROL_COMMAND);
+    Wire.write((uint8_t)(OLED_SET_PAGE | page));
+    Wire.write((uint8_t)(OLED_SET_COLUMN_LOW | (ramColumn & 0x0F)));
+    Wire.write((uint8_t)(OLED_SET_COLUMN_HIGH | (ramColumn >> 4)));
+    Wire.endTransmission();
+
+    // The column pointer advances by itself, so long runs just continue in the next transaction
+    while (count > 0)
+    {
+        int chunk = count < OLED_I2C_CHUNK ? count : OLED_I2C_CHUNK;
+        Wire.beginTransmission(OLED_I2C_ADDRESS);
+        Wire.write(OLED_CONTROL_DATA);
+        Wire.write(data, chunk);
+        Wire.endTransmission();
+        data += chunk;
+        count -= chunk;
+    }
+}
+
+// Send the runs of a frame that differ from the panel RAM
+static void sendChanges(const uint8_t *frame)
+{
+    // The page and column commands below only apply in page addressing mode
+    if (!shownValid)
+    {
+        Wire.beginTransmission(OLED_I2C_ADDRESS);
+        Wire.write(OLED_CONTROL_COMMAND);
+        Wire.write(OLED_SET_ADDRESSING_MODE);
+        Wire.write(OLED_PAGE_ADDRESSING);
+        Wire.endTransmission();
+    }
+
+    for (int page = 0; page < OLED_PAGES; ++page)
+    {
+        const uint8_t *row = frame + page * OLED_WIDTH;
+        uint8_t *shown = shownFrame[page];
+
+        // One run per page from the first to the last changed column, the command overhead of
+        // splitting it further costs more than resending a few unchanged bytes
+        int first = 0;
+        int last = OLED_WIDTH - 1;
+        if (shownValid)
+        {
+            while (first < OLED_WIDTH && row[first] == shown[first])
+                ++first;
+            if (first == OLED_WIDTH)
+                continue;
+            while (row[last] == shown[last])
+                --last;
+        }
+
+        sendRun(page, first, row + first, last - first + 1);
+        memcpy(shown + first, row + first, last - first + 1);
+    }
+
+    shownValid = true;
+}
+
+// Stretch the interval while the renderer is short of headroom or the DAC bus sharing Wire has
+// been starved, then ease back one step per frame once things recover
+static TickType_t flushInterval()
+{
+    static int backoff = 1;
+    static uint32_t lastUnderruns = 0;
+
+    uint32_t underruns = getDacStats().underruns;
+    bool strained = getAudioLoad() > OLED_BACKOFF_LOAD || underruns != lastUnderruns;
+    lastUnderruns = underruns;
+
+    if (strained)
+        backoff = backoff * 2 < OLED_MAX_BACKOFF ? backoff * 2 : OLED_MAX_BACKOFF;
+    else if (backoff > 1)
+        --backoff;
+
+    return pdMS_TO_TICKS(1000 / OLED_MAX_FPS) * backoff;
+}
+
+static void flushTask(void *parameter)
+{
+    TickType_t lastFlush = xTaskGetTickCount();
+    TickType_t busFree = 0; // Rest after the last flush that keeps the display within OLED_BUS_SHARE
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Hold off until the interval has passed, frames presented meanwhile replace this one
+        TickType_t interval = flushInterval();
+        interval = interval > busFree ? interval : busFree;
+        TickType_t elapsed = xTaskGetTickCount() - lastFlush;
+        if (elapsed < interval)
+        {
+            vTaskDelay(interval - elapsed);
+        }
+
+        xSemaphoreTake(frontLock, portMAX_DELAY);
+        bool pending = framePending;
+        if (pending)
+        {
+            memcpy(sendingFrame, frontFrame, sizeof(sendingFrame));
+            framePending = false;
+        }
+        xSemaphoreGive(frontLock);
+
+        if (pending)
+        {
+            int64_t started = esp_timer_get_time();
+            sendChanges(&sendingFrame[0][0]);
+            lastFlush = xTaskGetTickCount();
+            uint32_t busyUs = (uint32_t)(esp_timer_get_time() - started);
+            busFree = pdMS_TO_TICKS(busyUs * (100 - OLED_BUS_SHARE) / OLED_BUS_SHARE / 1000);
+        }
+    }
+}
+
+void initDisplayFlush()
+{
+    frontLock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(flushTask, "oled", 2048, NULL, OLED_TASK_PRIORITY, &flushTaskHandle, 0);
+}
+
+void presentDisplay()
+{
+    // Before the service starts, as during boot, frames go out synchronously
+    if (flushTaskHandle == NULL)
+    {
+        sendChanges(display.getBuffer());
+        return;
+    }
+
+    xSemaphoreTake(frontLock, portMAX_DELAY);
+    memcpy(frontFrame, display.getBuffer(), sizeof(frontFrame));
+    framePending = true;
+    xSemaphoreGive(frontLock);
+    xTaskNotifyGive(flushTaskHandle);
+}
+
+void invalidateDisplay()
+{
+    shownValid = false;
+}
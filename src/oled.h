@@ -0,0 +1,59 @@
+/*
+ * File: oled.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef OLED_H
+#define OLED_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+// Panel geometry and wiring, the SSD1305 shares Wire with the first DAC bus
+#define OLED_WIDTH 128
+#define OLED_HEIGHT 64
+#define OLED_PAGES (OLED_HEIGHT / 8) // Each page is one row of bytes, eight pixels tall
+#define OLED_I2C_ADDRESS 0x3C
+#define OLED_COLUMN_OFFSET 0 // First RAM column wired to the panel, the SSD1305 has 132
+#define OLED_I2C_CHUNK 16    // Data bytes per transaction, about 450 us, which fits the headroom of a DAC frame
+
+// Flush service: drawing goes into the Adafruit framebuffer, presentDisplay() copies the finished
+// frame into a front buffer and returns. A low-priority task sends it, at most OLED_MAX_FPS times a
+// second and only the runs of each page that changed since the last frame sent. Frames presented
+// faster than that collapse into the newest. Flushes also hold to OLED_BUS_SHARE percent of the
+// bus time, which the DAC frame rate leaves free on the first bus, see DAC_FRAME_SHARE.
+#define OLED_MAX_FPS 30
+#define OLED_BUS_SHARE 20
+#define OLED_MAX_BACKOFF 8      // Divides OLED_MAX_FPS while audio is under strain
+#define OLED_BACKOFF_LOAD 75    // Audio load, in percent, that counts as strain
+#define OLED_TASK_PRIORITY (tskIDLE_PRIORITY + 1) // Below the UI task, which only draws
+
+void initDisplayFlush();
+void presentDisplay();
+
+// Resend everything with the next frame, after begin() or anything else that rewrote the panel RAM
+void invalidateDisplay();
+
+#endif
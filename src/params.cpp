@@ -0,0 +1,71 @@
+/*
+ * File: params.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "params.h"
+#include "platform.h"
+#include <atomic>
+#include <string.h>
+
+// Two snapshot buffers guarded by one sequence counter. Publish k writes buffer k & 1 and moves
+// the sequence to 2k - 1 while writing and 2k once done, so the newest complete snapshot is always
+// sequence / 2, and a reader only has to retry if the writer lapped it onto the same buffer.
+static SynthParams paramBuffers[2];
+static std::atomic<uint32_t> paramSequence(0);
+
+void publishParams(const SynthParams &params)
+{
+    uint32_t sequence = paramSequence.load(std::memory_order_relaxed);
+    uint32_t version = sequence / 2 + 1;
+
+    paramSequence.store(2 * version - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(&paramBuffers[version & 1], &params, sizeof(SynthParams));
+
+    paramSequence.store(2 * version, std::memory_order_release);
+}
+
+bool IRAM_ATTR acquireParams(SynthParams &params, uint32_t &lastVersion)
+{
+    for (;;)
+    {
+        uint32_t sequence = paramSequence.load(std::memory_order_acquire);
+        uint32_t version = sequence / 2;
+        if (version == lastVersion)
+            return false;
+
+        memcpy(&params, &paramBuffers[version & 1], sizeof(SynthParams));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Buffer version & 1 is only rewritten once publish version + 2 begins
+        if (paramSequence.load(std::memory_order_relaxed) < 2 * (version + 2) - 1)
+        {
+            lastVersion = version;
+            return true;
+        }
+    }
+}
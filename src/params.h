@@ -0,0 +1,55 @@
+/*
+ * File: params.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <stdint.h>
+#include "synth.h"
+
+// Everything the audio engine takes from the UI, handed over as one consistent snapshot
+struct SynthParams
+{
+    float harmonicAmplitudes[numPartials];
+    float harmonicPanning[numPartials]; // 0.0 is full left, 1.0 is full right
+    float modulationMatrix[numPartials][numPartials];
+    float baseFrequency;
+    WaveformType waveform;
+    int scale; // Index into scales[], see tuning.h
+    CVMode cvAssignments[4];
+    float morphSeconds; // Time the engine takes to move from what it plays to this snapshot, 0 switches at once
+    uint32_t eventsTaken; // appliedEventsTaken() when published, see events.h
+};
+
+// UI side, single writer. Never blocks, the snapshot lands in whichever buffer the engine is not reading.
+void publishParams(const SynthParams &params);
+
+// Audio side, single reader. Copies the newest snapshot when its version differs from lastVersion
+// and returns true; lastVersion is updated to the version copied.
+bool acquireParams(SynthParams &params, uint32_t &lastVersion);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * File: pitch.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "pitch.h"
+#include "tables.h"
+#include <stdint.h>
+#include <string.h>
+
+// Uncalibrated inputs follow the nominal mapping of the full CV range onto one octave below the base
+static PitchCalibration pitchCalibration[CV_INPUT_COUNT];
+
+void initPitch()
+{
+    for (int channel = 0; channel < CV_INPUT_COUNT; ++channel)
+    {
+        for (int p = 0; p < PITCH_CALIBRATION_POINTS; ++p)
+        {
+            pitchCalibration[channel].octaves[p] = (float)p / (PITCH_CALIBRATION_POINTS - 1) - 1.0f;
+        }
+    }
+}
+
+float IRAM_ATTR fastExp2(float x)
+{
+    // Keep the result inside the normal float range
+    if (x < -126.0f)
+        x = -126.0f;
+    if (x > 127.0f)
+        x = 127.0f;
+
+    int whole = floorToInt(x);
+    float scaled = (x - whole) * EXP2_TABLE_SIZE;
+    int index = (int)scaled;
+    float t = (scaled - index) * (0.69314718f / EXP2_TABLE_SIZE); // Remainder in units of ln(2)
+
+    // 2^r for r below 1/32 of an octave, the dropped cubic term stays under 2e-6
+    float mantissa = exp2Table[index] * (1.0f + t * (1.0f + 0.5f * t));
+
+    // Apply the whole octaves straight to the exponent field
+    int32_t bits;
+    memcpy(&bits, &mantissa, sizeof(bits));
+    bits += whole << 23;
+    memcpy(&mantissa, &bits, sizeof(bits));
+    return mantissa;
+}
+
+float IRAM_ATTR cvToOctaves(int channel, float cv)
+{
+    const PitchCalibration &calibration = pitchCalibration[channel];
+    float position = cv * (PITCH_CALIBRATION_POINTS - 1);
+
+    // Extrapolate past either end along the outermost segment
+    int segment = floorToInt(position);
+    if (segment < 0)
+        segment = 0;
+    if (segment > PITCH_CALIBRATION_POINTS - 2)
+        segment = PITCH_CALIBRATION_POINTS - 2;
+
+    float fraction = position - segment;
+    return calibration.octaves[segment] + (calibration.octaves[segment + 1] - calibration.octaves[segment]) * fraction;
+}
+
+void setPitchCalibration(int channel, const PitchCalibration &calibration)
+{
+    if (channel >= 0 && channel < CV_INPUT_COUNT)
+    {
+        pitchCalibration[channel] = calibration;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * File: pitch.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef PITCH_H
+#define PITCH_H
+
+#include "cv.h"
+#include "platform.h"
+
+// 2^x from a table of 2^(k / 32) refined by a quadratic over the remaining 1/32 of an octave,
+// accurate to a few millionths (well under a hundredth of a cent)
+#define EXP2_TABLE_BITS 5
+#define EXP2_TABLE_SIZE (1 << EXP2_TABLE_BITS)
+
+// Octaves per CV input, sampled at evenly spaced points across the normalized 0.0-1.0 CV range
+#define PITCH_CALIBRATION_POINTS 9
+
+struct PitchCalibration
+{
+    float octaves[PITCH_CALIBRATION_POINTS];
+};
+
+void initPitch();
+float fastExp2(float x);
+
+// floorf() lives in the flash-resident libm, the audio path rounds down itself
+static inline int IRAM_ATTR floorToInt(float x)
+{
+    int whole = (int)x;
+    return x < whole ? whole - 1 : whole;
+}
+
+// Map a normalized CV reading to octaves through the calibration table of its input
+float cvToOctaves(int channel, float cv);
+void setPitchCalibration(int channel, const PitchCalibration &calibration);
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * File: platform.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdint.h>
+
+// The synthesis core (synth, mixer, params, events, pitch, tables, wavetable) builds without the
+// Arduino core, so it also runs on a desktop host, see host/. What it and the code timing it need from
+// the platform lives here: memory placement attributes and a cycle counter.
+#if defined(ARDUINO_ARCH_ESP32)
+
+#include <Arduino.h>
+
+#define SYNTH_HOST 0
+
+// CPU clock cycles, wraps every few tens of seconds at 240 MHz
+static inline uint32_t platformCycleCount()
+{
+    return ESP.getCycleCount();
+}
+
+#else
+
+#define SYNTH_HOST 1
+
+// Memory placement only means something on the device
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+#ifndef DRAM_ATTR
+#define DRAM_ATTR
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint32_t platformCycleCount()
+{
+    return (uint32_t)__rdtsc(); // Reference cycles of the time-stamp counter
+}
+#elif defined(__aarch64__)
+static inline uint32_t platformCycleCount()
+{
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks)); // Generic timer ticks, slower than the core clock
+    return (uint32_t)ticks;
+}
+#else
+#include <chrono>
+static inline uint32_t platformCycleCount()
+{
+    return (uint32_t)std::chrono::steady_clock::now().time_since_epoch().count(); // Nanoseconds
+}
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,244 @@
+/*
+ * File: presets.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#include "presets.h"
+#include "ui.h"
+#include "tuning.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stdio.h>
+#include <string.h>
+
+extern float harmonicAmplitudes[];
+extern float harmonicPanning[];
+extern float modulationMatrix[numPartials][numPartials];
+extern CVMode cvAssignments[];
+extern WaveformType currentWaveform;
+extern float baseFrequency;
+extern int baseFrequencyIndex;
+extern int scaleIndex;
+
+static Preferences presetStore;
+static int lastSlot = -1;
+
+#define LAST_SLOT_KEY "last"
+
+static void presetKey(int slot, char key[8])
+{
+    snprintf(key, 8, "slot%d", slot);
+}
+
+static inline uint16_t quantize(float value, float one, float high)
+{
+    value = value < 0.0f ? 0.0f : value > high ? high : value;
+    return (uint16_t)(value * one + 0.5f);
+}
+
+static inline void putWord(uint8_t *&out, uint16_t value)
+{
+    *out++ = (uint8_t)(value & 0xFF);
+    *out++ = (uint8_t)(value >> 8);
+}
+
+static inline uint16_t getWord(const uint8_t *&in)
+{
+    uint16_t value = (uint16_t)(in[0] | (in[1] << 8));
+    in += 2;
+    return value;
+}
+
+// Only saving writes the slot to NVS. A flash write stalls both cores for longer than the DMA queue
+// covers, and the save has already paid that cost when it wrote the blob.
+static void rememberSlot(int slot, bool store)
+{
+    if (store && presetStore.getUChar(LAST_SLOT_KEY, 0xFF) != slot)
+        presetStore.putUChar(LAST_SLOT_KEY, (uint8_t)slot);
+    lastSlot = slot;
+}
+
+void initPresets()
+{
+    presetStore.begin("presets", false);
+    uint8_t slot = presetStore.getUChar(LAST_SLOT_KEY, 0xFF);
+    lastSlot = slot < PRESET_SLOTS ? slot : -1;
+}
+
+int lastPresetSlot()
+{
+    return lastSlot;
+}
+
+bool restoreLastPreset()
+{
+    return lastSlot >= 0 && loadPreset(lastSlot, 0.0f);
+}
+
+bool presetExists(int slot)
+{
+    char key[8];
+    presetKey(slot, key);
+    return slot >= 0 && slot < PRESET_SLOTS && presetStore.isKey(key);
+}
+
+bool savePreset(int slot)
+{
+    if (slot < 0 || slot >= PRESET_SLOTS)
+        return false;
+
+    uint8_t *buffer = new uint8_t[PRESET_BYTES(numPartials)];
+    uint8_t *out = buffer;
+    putWord(out, PRESET_MAGIC);
+    *out++ = PRESET_VERSION;
+    *out++ = (uint8_t)numPartials;
+
+    *out++ = (uint8_t)currentWaveform;
+    *out++ = (uint8_t)baseFrequencyIndex;
+    *out++ = (uint8_t)scaleIndex;
+    for (int i = 0; i < 4; ++i)
+    {
+        *out++ = (uint8_t)cvAssignments[i];
+    }
+    memcpy(out, &baseFrequency, sizeof(float)); // Little endian, as the ESP32
+    out += sizeof(float);
+
+    for (int i = 0; i < numPartials; ++i)
+    {
+        putWord(out, quantize(harmonicAmplitudes[i], 16384.0f, 65535.0f / 16384.0f));
+        putWord(out, quantize(harmonicPanning[i], 32768.0f, 1.0f));
+    }
+
+    for (int i = 0; i < numPartials; ++i)
+    {
+        for (int j = 0; j < numPartials; ++j)
+        {
+            float amount = modulationMatrix[i][j];
+            amount = amount < -127.0f ? -127.0f : amount > 127.0f ? 127.0f : amount;
+            *out++ = (uint8_t)(int8_t)lroundf(amount);
+        }
+    }
+
+    char key[8];
+    presetKey(slot, key);
+    size_t length = out - buffer;
+    bool saved = presetStore.putBytes(key, buffer, length) == length;
+    delete[] buffer;
+
+    if (saved)
+    {
+        rememberSlot(slot, true);
+    }
+    return saved;
+}
+
+// Unpack a preset into the settings, leaving them untouched unless the whole blob checks out
+static bool decodePreset(const uint8_t *in, size_t length)
+{
+    if (length < PRESET_HEADER_BYTES || getWord(in) != PRESET_MAGIC)
+        return false;
+    if (*in++ != PRESET_VERSION)
+        return false;
+
+    int partials = *in++;
+    if (length != (size_t)PRESET_BYTES(partials))
+        return false;
+
+    uint8_t waveform = *in++;
+    uint8_t frequencyIndex = *in++;
+    uint8_t scale = *in++;
+    if (waveform > PULSE || frequencyIndex > 3 || scale >= scaleCount)
+        return false;
+    uint8_t modes[4];
+    memcpy(modes, in, sizeof(modes));
+    in += sizeof(modes);
+    float frequency;
+    memcpy(&frequency, in, sizeof(float));
+    in += sizeof(float);
+    if (!(frequency > 0.0f && frequency < AUDIO_SAMPLE_RATE / 2.0f))
+        return false; // NaN included
+
+    currentWaveform = (WaveformType)waveform;
+    baseFrequencyIndex = frequencyIndex;
+    baseFrequency = frequency;
+    scaleIndex = scale;
+    for (int i = 0; i < 4; ++i)
+    {
+        cvAssignments[i] = modes[i] <= PITCH_1V_OCT ? (CVMode)modes[i] : NONE;
+    }
+
+    for (int i = 0; i < numPartials; ++i)
+    {
+        harmonicAmplitudes[i] = 0.0f;
+        harmonicPanning[i] = 0.5f;
+        for (int j = 0; j < numPartials; ++j)
+        {
+            modulationMatrix[i][j] = 0.0f;
+        }
+    }
+
+    for (int i = 0; i < partials; ++i)
+    {
+        float amplitude = getWord(in) * (1.0f / 16384.0f);
+        float pan = getWord(in) * (1.0f / 32768.0f);
+        if (i < numPartials)
+        {
+            harmonicAmplitudes[i] = amplitude;
+            harmonicPanning[i] = pan;
+        }
+    }
+
+    for (int i = 0; i < partials; ++i)
+    {
+        for (int j = 0; j < partials; ++j)
+        {
+            float amount = (float)(int8_t)*in++;
+            if (i < numPartials && j < numPartials)
+                modulationMatrix[i][j] = amount;
+        }
+    }
+    return true;
+}
+
+bool loadPreset(int slot, float morphSeconds)
+{
+    if (!presetExists(slot))
+        return false;
+
+    char key[8];
+    presetKey(slot, key);
+    size_t length = presetStore.getBytesLength(key);
+    uint8_t *buffer = new uint8_t[length];
+    bool loaded = presetStore.getBytes(key, buffer, length) == length && decodePreset(buffer, length);
+    delete[] buffer;
+
+    if (loaded)
+    {
+        publishSettings(morphSeconds);
+        rememberSlot(slot, false); // Loading is a performance action, it never touches flash
+    }
+    return loaded;
+}
@@ -0,0 +1,65 @@
+/*
+ * File: presets.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef PRESETS_H
+#define PRESETS_H
+
+#include <stdint.h>
+#include "synth.h"
+
+// Presets live in NVS, one blob per slot in a compact versioned format:
+//
+//   header   magic "OS", format version, partial count
+//   settings waveform, base frequency menu index, scale index, four CV assignments, base frequency
+//            in Hz as a 32-bit float, which MIDI and the serial protocol can set off the menu
+//   partials amplitude in unsigned Q14 and pan in unsigned Q15, 16 bits each per partial
+//   matrix   one signed byte per entry, the editor's -100 to 100 in whole steps
+//
+// Presets saved with another partial count load the partials both builds have, the rest silent.
+#define PRESET_SLOTS 8
+#define PRESET_MAGIC 0x534F // "OS"
+#define PRESET_VERSION 1
+#define PRESET_HEADER_BYTES 4
+#define PRESET_SETTINGS_BYTES 11
+#define PRESET_BYTES(partials) (PRESET_HEADER_BYTES + PRESET_SETTINGS_BYTES + (partials) * 4 + (partials) * (partials))
+#define PRESET_MORPH_SECONDS 2.0f
+
+void initPresets();
+bool presetExists(int slot);
+bool savePreset(int slot);
+
+// Load a slot into the settings and hand it to the engine as one snapshot, taking effect within a
+// block, or morphing there over morphSeconds
+bool loadPreset(int slot, float morphSeconds);
+
+// The slot loaded or saved most recently, -1 before any. Only saves are kept across power cycles,
+// so boot restores the slot saved last.
+int lastPresetSlot();
+bool restoreLastPreset(); // Loads it at once, for boot
+
+#endif
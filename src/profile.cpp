@@ -0,0 +1,178 @@
+/*
+ * File: profile.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#include "profile.h"
+
+#if SYNTH_PROFILE
+
+#include "audio.h"
+#include "cv.h"
+#include "control.h"
+#include "dac.h"
+#include "ui.h"
+#include "governor.h"
+#include "synth.h"
+
+static_assert(PROFILE_CV - PROFILE_DAC_BUS == DAC_BUS_COUNT, "One DAC probe per I2C bus");
+
+struct ProfileStats
+{
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t overruns; // Sections that took longer than their deadline
+    uint32_t generation; // Matches profileGeneration once cleared since the last reset
+    uint32_t buckets[PROFILE_BUCKETS];
+};
+
+static const char *const probeNames[PROFILE_PROBE_COUNT] = {"audio", "output", "dac bus 0", "dac bus 1", "cv", "draw"};
+
+// Time each section may take, in microseconds
+static const uint32_t probeDeadlines[PROFILE_PROBE_COUNT] = {
+    1000000ULL * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE,
+    1000000ULL * AUDIO_BLOCK_SIZE / AUDIO_SAMPLE_RATE,
+    1000000 / DAC_FRAME_RATE,
+    1000000 / DAC_FRAME_RATE,
+    1000000 / CV_SAMPLE_RATE,
+    1000000 / UI_FRAME_RATE,
+};
+
+static ProfileStats probes[PROFILE_PROBE_COUNT];
+static uint32_t deadlineCycles[PROFILE_PROBE_COUNT];
+static uint32_t bucketCycles[PROFILE_PROBE_COUNT];
+static volatile uint32_t profileGeneration = 1;
+
+void initProfiler()
+{
+    uint32_t cyclesPerMicrosecond = ESP.getCpuFreqMHz();
+    for (int i = 0; i < PROFILE_PROBE_COUNT; ++i)
+    {
+        deadlineCycles[i] = probeDeadlines[i] * cyclesPerMicrosecond;
+        bucketCycles[i] = deadlineCycles[i] / PROFILE_BUCKETS_PER_DEADLINE;
+        if (bucketCycles[i] == 0)
+            bucketCycles[i] = 1;
+    }
+}
+
+// Called from the timer interrupt on the fallback audio path, so it stays in IRAM. Only the owning
+// task writes a probe, a reset just moves the generation on and the owner clears on its next record.
+void IRAM_ATTR profileRecord(ProfileProbe probe, uint32_t cycles)
+{
+    ProfileStats &stats = probes[probe];
+
+    uint32_t generation = profileGeneration;
+    if (stats.generation != generation)
+    {
+        memset(&stats, 0, sizeof(stats));
+        stats.minCycles = UINT32_MAX;
+        stats.generation = generation;
+    }
+
+    stats.count++;
+    stats.totalCycles += cycles;
+    if (cycles < stats.minCycles)
+        stats.minCycles = cycles;
+    if (cycles > stats.maxCycles)
+        stats.maxCycles = cycles;
+    if (cycles > deadlineCycles[probe])
+        stats.overruns++;
+
+    uint32_t bucket = cycles / bucketCycles[probe];
+    stats.buckets[bucket < PROFILE_BUCKETS ? bucket : PROFILE_BUCKETS - 1]++;
+}
+
+void resetProfile()
+{
+    profileGeneration = profileGeneration + 1;
+}
+
+// Upper edge of the bucket holding the 99th percentile, never above the slowest section seen
+static uint32_t percentile99(const ProfileStats &stats, int probe)
+{
+    uint32_t threshold = stats.count - stats.count / 100;
+    uint32_t seen = 0;
+    for (int bucket = 0; bucket < PROFILE_BUCKETS - 1; ++bucket)
+    {
+        seen += stats.buckets[bucket];
+        if (seen >= threshold)
+        {
+            uint32_t edge = (bucket + 1) * bucketCycles[probe];
+            return edge < stats.maxCycles ? edge : stats.maxCycles;
+        }
+    }
+    return stats.maxCycles;
+}
+
+void dumpProfile(Print &out)
+{
+    uint32_t cyclesPerMicrosecond = ESP.getCpuFreqMHz();
+
+    out.println("probe        count    min    avg    max    p99 deadline overruns (us)");
+    for (int i = 0; i < PROFILE_PROBE_COUNT; ++i)
+    {
+        ProfileStats stats = probes[i]; // Copied while the owner keeps recording, close enough for a report
+        if (stats.generation != profileGeneration || stats.count == 0)
+        {
+            out.printf("%-10s %7u\n", probeNames[i], 0u);
+            continue;
+        }
+
+        out.printf("%-10s %7u %6u %6u %6u %6u %8u %8u\n", probeNames[i], stats.count,
+                   stats.minCycles / cyclesPerMicrosecond,
+                   (uint32_t)(stats.totalCycles / stats.count / cyclesPerMicrosecond),
+                   stats.maxCycles / cyclesPerMicrosecond,
+                   percentile99(stats, i) / cyclesPerMicrosecond,
+                   probeDeadlines[i], stats.overruns);
+    }
+
+    DacStats dac = getDacStats();
+    out.printf("dac frames %u underruns %u overruns %u i2c errors %u\n",
+               dac.framesWritten, dac.underruns, dac.overruns, dac.i2cErrors);
+    out.printf("control changes dropped %u\n", getControlDrops());
+    out.printf("audio load %u%% overruns %u, governor level %d, partials %d of %d\n", getAudioLoad(),
+               getAudioOverruns(), governorLevel(), partialLimit(), numPartials);
+}
+
+void profilerCommand(int command)
+{
+    switch (command)
+    {
+    case 'p':
+        dumpProfile(Serial);
+        break;
+    case 'r':
+        resetProfile();
+        Serial.println("profile cleared");
+        break;
+    default:
+        break;
+    }
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * File: profile.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// Set to 1 to time the audio, output, CV and drawing paths with the CPU cycle counter. Off, every
+// probe compiles away. On, send 'p' over the serial link to print the statistics and 'r' to clear them.
+#ifndef SYNTH_PROFILE
+#define SYNTH_PROFILE 0
+#endif
+
+// Each probe keeps a histogram of PROFILE_BUCKETS buckets, PROFILE_BUCKETS_PER_DEADLINE of them
+// spanning its deadline, so the last bucket collects everything beyond twice the deadline
+#define PROFILE_BUCKETS 64
+#define PROFILE_BUCKETS_PER_DEADLINE 32
+
+// Timed sections, each only ever recorded from one task or interrupt
+enum ProfileProbe
+{
+    PROFILE_AUDIO,                    // One audio block, or one sample interrupt on the timer path
+    PROFILE_OUTPUT,                   // Handing a block or sample to the DACs and the capture ring
+    PROFILE_DAC_BUS,                  // One frame written on an I2C bus, one probe per bus
+    PROFILE_CV = PROFILE_DAC_BUS + 2, // One pass over every CV input
+    PROFILE_DRAW,                     // One frame drawn into the framebuffer
+    PROFILE_PROBE_COUNT
+};
+
+#if SYNTH_PROFILE
+
+#include <Arduino.h>
+#include "platform.h"
+
+void initProfiler();
+void profilerCommand(int command); // Serves one byte of the serial link, the control task hands them over
+void dumpProfile(Print &out);
+void resetProfile();
+void profileRecord(ProfileProbe probe, uint32_t cycles);
+
+static inline uint32_t profileStart()
+{
+    return platformCycleCount();
+}
+
+static inline void profileEnd(ProfileProbe probe, uint32_t startCycles)
+{
+    profileRecord(probe, platformCycleCount() - startCycles);
+}
+
+#else
+
+static inline void initProfiler() {}
+static inline void profilerCommand(int) {}
+static inline uint32_t profileStart() { return 0; }
+static inline void profileEnd(ProfileProbe, uint32_t) {}
+
+#endif
+
+#endif
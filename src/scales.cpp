@@ -0,0 +1,50 @@
+/*
+ * File: scales.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+// Generated by host/scala_tables.py from resources/scales, edit the .scl files and rerun it
+
+#include "tuning.h"
+#include "platform.h"
+
+// Degrees in octaves above the tonic, ascending from 0 and below the period. The engine copies
+// them on a scale change in the middle of rendering, so they sit in DRAM like its other tables.
+static const float majorDegrees[] DRAM_ATTR = {0.0f, 0.166666667f, 0.333333333f, 0.416666667f, 0.583333333f, 0.75f, 0.916666667f};
+static const float minorDegrees[] DRAM_ATTR = {0.0f, 0.166666667f, 0.25f, 0.416666667f, 0.583333333f, 0.666666667f, 0.833333333f};
+static const float naturalHarmonicDegrees[] DRAM_ATTR = {0.0f, 0.169925001f, 0.321928095f, 0.459431619f, 0.584962501f, 0.700439718f, 0.807354922f};
+static const float pentatonicDegrees[] DRAM_ATTR = {0.0f, 0.169925001f, 0.321928095f, 0.584962501f, 0.807354922f};
+static const float bohlenPierceDegrees[] DRAM_ATTR = {0.0f, 0.121920192f, 0.243840383f, 0.365760575f, 0.487680767f, 0.609600958f, 0.731521158f, 0.85344135f, 0.975361542f, 1.09728173f, 1.21920193f, 1.34112212f, 1.46304231f};
+
+const Scale scales[] DRAM_ATTR = {
+    {"Harmonic", 0, 1.0f, 0}, // Partials on the harmonic series, CV pitch unquantized
+    {"Major", 7, 1.0f, majorDegrees},
+    {"Minor", 7, 1.0f, minorDegrees},
+    {"Natural Harmonic", 7, 1.0f, naturalHarmonicDegrees},
+    {"Pentatonic", 5, 1.0f, pentatonicDegrees},
+    {"Bohlen-Pierce", 13, 1.5849625f, bohlenPierceDegrees},
+};
+
+const int scaleCount DRAM_ATTR = sizeof(scales) / sizeof(scales[0]);
@@ -0,0 +1,517 @@
+/*
+ * File: synth.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "synth.h"
+#include "platform.h"
+#include "events.h"
+#include "mixer.h"
+#include "params.h"
+#include "pitch.h"
+#include "tables.h"
+#include "tuning.h"
+#include "wavetable.h"
+#include <atomic>
+#include <string.h>
+
+// Everything the audio path reads and writes between blocks, in one zero-initialised struct so it
+// sits together in internal DRAM, aligned for the block kernels' loads. Like the code working on it,
+// nothing in here is reached through the flash cache.
+struct alignas(16) EngineState
+{
+    // Oscillator state as structure-of-arrays, a full cycle spans the whole 32-bit phase range.
+    // Increment, amplitude and pan ramp toward their targets, which are recomputed once per control block.
+    uint32_t oscPhase[numPartials];
+    int32_t oscIncrement[numPartials];
+    int32_t oscIncrementTarget[numPartials];
+    int32_t oscIncrementStep[numPartials];
+    ramp_t oscAmplitude[numPartials];
+    ramp_t oscAmplitudeTarget[numPartials];
+    ramp_t oscAmplitudeStep[numPartials];
+    ramp_t oscPan[numPartials];
+    ramp_t oscPanTarget[numPartials];
+    ramp_t oscPanStep[numPartials];
+    const int16_t *oscTable[numPartials]; // Wavetable level for the current control block
+    WaveformType oscWaveform;
+    int controlFramesLeft;
+    uint32_t frameClock; // Frames rendered so far, the clock control events are stamped on
+
+    // The scale being played and each partial's multiple of the base frequency in it
+    Tuning tuning;
+    float partialFactors[numPartials];
+    int tunedScale;
+    bool tuned;
+
+    // The engine's own copy of the UI settings, refreshed from the published snapshot between blocks.
+    // A snapshot asking for a morph lands in incoming, and params moves toward it on every control update.
+    SynthParams params;
+    SynthParams incoming;
+    uint32_t paramsVersion;
+    float morphRemaining; // Share of the way still to go to incoming, 0 when not morphing
+    float morphStep;      // Share per frame
+    int morphFrames;      // Rendered since params last moved
+};
+
+static EngineState engine;
+
+// Set by the CPU governor from the UI task, read once per control block
+static std::atomic<int> partialCap(numPartials);
+
+// Phase increment per Hz at the output sample rate
+static const float phaseScale = 4294967296.0f / AUDIO_SAMPLE_RATE;
+
+static const float nyquist = AUDIO_SAMPLE_RATE / 2.0f;
+
+// Convert a frequency to a phase increment, frequencies beyond the sample rate wrap like any DDS
+static inline uint32_t IRAM_ATTR phaseIncrement(float frequency)
+{
+    return (uint32_t)(int64_t)(frequency * phaseScale);
+}
+
+// sin() of a 32-bit phase, folded onto the quarter wave around zero and evaluated by its Taylor
+// series up to x^11, which stays within 1e-7. Only used to seed the sine partials once per run.
+static inline float IRAM_ATTR sinePhase(uint32_t phase)
+{
+    int32_t folded = (int32_t)phase; // Half a cycle either side of zero
+    if (folded > 0x40000000 || folded < -0x40000000)
+    {
+        folded = (int32_t)(0x80000000u - (uint32_t)folded); // sin(pi - x) = sin(x)
+    }
+
+    float x = (float)folded * (3.14159265f / 2147483648.0f);
+    float x2 = x * x;
+    return x * (1.0f + x2 * (-1.0f / 6 + x2 * (1.0f / 120 + x2 * (-1.0f / 5040 + x2 * (1.0f / 362880 + x2 * (-1.0f / 39916800))))));
+}
+
+static inline void IRAM_ATTR morphValues(float *values, const float *targets, int count, float fraction)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        values[i] += (targets[i] - values[i]) * fraction;
+    }
+}
+
+// Move params toward incoming by the frames rendered since the last step, a whole control block or
+// the part of one a control event cut short. Each step covers its share of what is left, which keeps
+// the path linear from wherever a new morph picked up a running one. Waveform, scale and CV
+// assignments cannot blend, they switch halfway.
+static void IRAM_ATTR advanceMorph()
+{
+    float step = engine.morphStep * engine.morphFrames;
+    engine.morphFrames = 0;
+    float remaining = engine.morphRemaining - step;
+    if (remaining <= 0.0f)
+    {
+        engine.params = engine.incoming;
+        engine.morphRemaining = 0.0f;
+        return;
+    }
+
+    float fraction = step / engine.morphRemaining;
+    morphValues(engine.params.harmonicAmplitudes, engine.incoming.harmonicAmplitudes, numPartials, fraction);
+    morphValues(engine.params.harmonicPanning, engine.incoming.harmonicPanning, numPartials, fraction);
+    morphValues(&engine.params.modulationMatrix[0][0], &engine.incoming.modulationMatrix[0][0], numPartials * numPartials, fraction);
+    engine.params.baseFrequency += (engine.incoming.baseFrequency - engine.params.baseFrequency) * fraction;
+
+    if (engine.morphRemaining > 0.5f && remaining <= 0.5f)
+    {
+        engine.params.waveform = engine.incoming.waveform;
+        engine.params.scale = engine.incoming.scale;
+        memcpy(engine.params.cvAssignments, engine.incoming.cvAssignments, sizeof(engine.params.cvAssignments));
+    }
+    engine.morphRemaining = remaining;
+}
+
+// Pick up a new scale, once per change: partial i sits on degree i counted up from the tonic, or on harmonic i + 1
+static void IRAM_ATTR retune(int scale)
+{
+    selectTuning(engine.tuning, scale);
+    for (int i = 0; i < numPartials; ++i)
+    {
+        engine.partialFactors[i] = engine.tuning.degreeCount ? degreeFactor(engine.tuning, i) : (float)(i + 1);
+    }
+    engine.tunedScale = scale;
+    engine.tuned = true;
+}
+
+// Control-rate stage: evaluate the modulation matrix and CV assignments once, then set every
+// oscillator ramping from where it stands toward the new targets over one control block. A control
+// event can start the next block early, the ramps then pick up from partway along.
+static void IRAM_ATTR updateControl(const float cvValues[])
+{
+    const bool landed = engine.controlFramesLeft == 0;
+    engine.oscWaveform = engine.params.waveform;
+    if (!engine.tuned || engine.params.scale != engine.tunedScale)
+    {
+        retune(engine.params.scale);
+    }
+    const bool quantized = engine.tuning.degreeCount > 0;
+    const int cap = partialCap.load(std::memory_order_relaxed);
+
+    // Exponential CV factors only depend on the input, so each is computed once per block
+    float cvFactors[4];
+    for (int cvIndex = 0; cvIndex < 4; ++cvIndex)
+    {
+        switch (engine.params.cvAssignments[cvIndex])
+        {
+        case EXP_FM:
+            cvFactors[cvIndex] = fastExp2(cvValues[cvIndex]);
+            break;
+        case PITCH_1V_OCT:
+        {
+            // Snapped to the nearest degree of the scale, which costs a short search over the cached degrees
+            float octaves = cvToOctaves(cvIndex, cvValues[cvIndex]);
+            cvFactors[cvIndex] = quantized ? quantizePitch(engine.tuning, octaves) : fastExp2(octaves);
+            break;
+        }
+        default:
+            cvFactors[cvIndex] = cvValues[cvIndex];
+            break;
+        }
+    }
+
+    for (int i = 0; i < numPartials; ++i)
+    {
+        // Apply modulation from other harmonics, capped partials only need their pitch kept
+        float modulatedFrequency = engine.params.baseFrequency * engine.partialFactors[i];
+        bool capped = i >= cap;
+        for (int j = 0; j < numPartials && !capped; ++j)
+        {
+            modulatedFrequency += engine.params.modulationMatrix[j][i] * engine.params.harmonicAmplitudes[j];
+        }
+
+        // Apply CV inputs
+        float amplitude = engine.params.harmonicAmplitudes[i];
+        for (int cvIndex = 0; cvIndex < 4; ++cvIndex)
+        {
+            switch (engine.params.cvAssignments[cvIndex])
+            {
+            case LIN_FM:
+                modulatedFrequency += cvFactors[cvIndex] * engine.params.baseFrequency;
+                break;
+            case EXP_FM:
+            case PITCH_1V_OCT: // Tracks through the input's calibration table
+                modulatedFrequency *= cvFactors[cvIndex];
+                break;
+            case AMPLITUDE:
+                amplitude *= cvFactors[cvIndex];
+                break;
+            case NONE:
+            default:
+                break;
+            }
+        }
+
+        // Land exactly on the previous targets before ramping toward the new ones
+        if (landed)
+        {
+            engine.oscIncrement[i] = engine.oscIncrementTarget[i];
+            engine.oscAmplitude[i] = engine.oscAmplitudeTarget[i];
+            engine.oscPan[i] = engine.oscPanTarget[i];
+        }
+
+        engine.oscIncrementTarget[i] = (int32_t)phaseIncrement(modulatedFrequency);
+        // Partials at or past Nyquist would alias, they fade out and are culled from rendering like
+        // the ones above the cap
+        if (capped || modulatedFrequency >= nyquist || modulatedFrequency <= -nyquist)
+        {
+            amplitude = 0.0f;
+        }
+
+        // Clamped to the range the fixed-point mix is sized for
+        amplitude = amplitude < 0.0f ? 0.0f : amplitude > 2.0f ? 2.0f : amplitude;
+        float pan = engine.params.harmonicPanning[i];
+        pan = pan < 0.0f ? 0.0f : pan > 1.0f ? 1.0f : pan;
+        engine.oscAmplitudeTarget[i] = toRamp(amplitude);
+        engine.oscPanTarget[i] = toRamp(pan);
+
+        // Pick the band-limited level for the faster end of the ramp, fading out past Nyquist
+        if (engine.oscWaveform != SINE)
+        {
+            int levelFrom = wavetableLevel((uint32_t)engine.oscIncrement[i]);
+            int levelTo = wavetableLevel((uint32_t)engine.oscIncrementTarget[i]);
+            int level = levelFrom > levelTo ? levelFrom : levelTo;
+            if (levelFrom < 0 || levelTo < 0)
+            {
+                engine.oscAmplitudeTarget[i] = 0;
+                level = WAVETABLE_LEVELS - 1;
+            }
+            engine.oscTable[i] = wavetable(engine.oscWaveform, level);
+        }
+
+        engine.oscIncrementStep[i] = (int32_t)(((int64_t)engine.oscIncrementTarget[i] - engine.oscIncrement[i]) / CONTROL_BLOCK_SIZE);
+        engine.oscAmplitudeStep[i] = (engine.oscAmplitudeTarget[i] - engine.oscAmplitude[i]) / CONTROL_BLOCK_SIZE;
+        engine.oscPanStep[i] = (engine.oscPanTarget[i] - engine.oscPan[i]) / CONTROL_BLOCK_SIZE;
+    }
+
+    engine.controlFramesLeft = CONTROL_BLOCK_SIZE;
+}
+
+// Advance a silent oscillator without rendering it, the phase lands where rendering would have
+// left it so a harmonic that fades back in stays aligned with the others
+static void IRAM_ATTR skipOscillator(int i, int frames)
+{
+    int32_t step = engine.oscIncrementStep[i];
+    engine.oscPhase[i] += (uint32_t)engine.oscIncrement[i] * frames + (uint32_t)step * (uint32_t)(frames * (frames - 1) / 2);
+    engine.oscIncrement[i] += step * frames;
+}
+
+// Sine partials run the Chebyshev recurrence y[n+1] = 2cos(w) y[n] - y[n-1] in Reinsch's form,
+// d[n+1] = d[n] - 4sin^2(w/2) y[n] and y[n+1] = y[n] + d[n+1], which keeps low partials precise
+// at two multiply-adds a sample. Every run reseeds it from the phase accumulator, so the
+// accumulator still sets the pitch and rounding never builds up; a glide holds its mean increment.
+static void IRAM_ATTR renderSinePartial(int i, sample_t *out, int frames)
+{
+    uint32_t phase = engine.oscPhase[i];
+    uint32_t increment = (uint32_t)(engine.oscIncrement[i] + (int32_t)((int64_t)engine.oscIncrementStep[i] * (frames - 1) / 2));
+    float halfSine = sinePhase(increment >> 1);
+    float lambda = 4.0f * halfSine * halfSine;
+    float y = sinePhase(phase);
+    float d = 2.0f * halfSine * sinePhase(phase - (increment >> 1) + 0x40000000u); // y[0] - y[-1]
+
+#if SYNTH_FIXED_POINT
+    // Q29 state and Q28 coefficient, the difference can reach 2 and the coefficient 4
+    int32_t lambdaQ = (int32_t)(lambda * (float)(1 << 28));
+    int32_t yQ = (int32_t)(y * (float)(1 << 29));
+    int32_t dQ = (int32_t)(d * (float)(1 << 29));
+    for (int n = 0; n < frames; ++n)
+    {
+        out[n] = yQ >> 14;
+        dQ = (int32_t)(dQ - (((int64_t)lambdaQ * yQ) >> 28));
+        yQ += dQ;
+    }
+#else
+    for (int n = 0; n < frames; ++n)
+    {
+        out[n] = y;
+        d -= lambda * y;
+        y += d;
+    }
+#endif
+
+    skipOscillator(i, frames);
+}
+
+// The other shapes read band-limited wavetables, advancing the phase frame by frame
+static void IRAM_ATTR renderWavetablePartial(int i, sample_t *out, int frames)
+{
+    uint32_t phase = engine.oscPhase[i];
+    int32_t increment = engine.oscIncrement[i];
+    int32_t step = engine.oscIncrementStep[i];
+    const int16_t *table = engine.oscTable[i];
+
+    for (int n = 0; n < frames; ++n)
+    {
+#if SYNTH_FIXED_POINT
+        out[n] = readWavetableQ15(table, phase);
+#else
+        out[n] = readWavetable(table, phase);
+#endif
+        phase += (uint32_t)increment;
+        increment += step;
+    }
+
+    engine.oscPhase[i] = phase;
+    engine.oscIncrement[i] = increment;
+}
+
+// Audio-rate stage: render each partial across the run, then scale and pan it onto the output
+// buses with the block kernels. Each partial's left share is its sample minus its right share, so
+// the left bus is the stereo sum minus the right bus and never needs its own pass.
+static void IRAM_ATTR renderFrames(AudioBlock &block, int offset, int frames)
+{
+    sample_t *left = block.left + offset;
+    sample_t *right = block.right + offset;
+    sample_t *stereo = block.stereo + offset;
+    sample_t partial[CONTROL_BLOCK_SIZE];
+    sample_t panned[CONTROL_BLOCK_SIZE];
+
+    mixClear(right, frames);
+    mixClear(stereo, frames);
+
+    for (int i = 0; i < numPartials; ++i)
+    {
+        // The first partials render straight into their individual wave outputs
+        sample_t *wave = i < numWaveOutputs ? block.wave[i] + offset : partial;
+
+        // Silent and culled partials cost nothing beyond keeping their phase
+        if (engine.oscAmplitude[i] == 0 && engine.oscAmplitudeStep[i] == 0)
+        {
+            skipOscillator(i, frames);
+            if (i < numWaveOutputs)
+                mixClear(wave, frames);
+            continue;
+        }
+
+        if (engine.oscWaveform == SINE)
+            renderSinePartial(i, wave, frames);
+        else
+            renderWavetablePartial(i, wave, frames);
+        mixApplyRamp(wave, wave, frames, engine.oscAmplitude[i], engine.oscAmplitudeStep[i]);
+        mixApplyRamp(wave, panned, frames, engine.oscPan[i], engine.oscPanStep[i]);
+        mixAdd(stereo, wave, frames); // Mixed for stereo output
+        mixAdd(right, panned, frames);
+
+        engine.oscAmplitude[i] += engine.oscAmplitudeStep[i] * frames;
+        engine.oscPan[i] += engine.oscPanStep[i] * frames;
+    }
+
+    mixSubtract(stereo, right, left, frames);
+}
+
+// Event values come from outside the module, so they are held to the range the editors allow, and
+// a NaN lands on the low end
+static inline float IRAM_ATTR clampEventValue(float value, float low, float high)
+{
+    return value > low ? (value < high ? value : high) : low;
+}
+
+// Set the value an event carries, clamped in the event itself so the UI mirrors what plays
+static void IRAM_ATTR applyEventTo(SynthParams &params, ControlEvent &event)
+{
+    switch (event.type)
+    {
+    case EVENT_FREQUENCY:
+        event.value = clampEventValue(event.value, 0.0f, nyquist);
+        params.baseFrequency = event.value;
+        break;
+    case EVENT_AMPLITUDE:
+        event.value = clampEventValue(event.value, 0.0f, 1.0f);
+        if (event.source < numPartials)
+            params.harmonicAmplitudes[event.source] = event.value;
+        break;
+    case EVENT_MATRIX:
+        event.value = clampEventValue(event.value, -100.0f, 100.0f);
+        if (event.source < numPartials && event.target < numPartials)
+            params.modulationMatrix[event.source][event.target] = event.value;
+        break;
+    default:
+        break;
+    }
+}
+
+// A control event sets the value in the settings playing now and in any morph target, so a morph
+// under way carries on from the new value instead of pulling back to the old one
+static void IRAM_ATTR applyEvent(ControlEvent &event)
+{
+    applyEventTo(engine.params, event);
+    applyEventTo(engine.incoming, event);
+}
+
+// Apply every queued event due by frame now, late ones included, and report whether any was
+static bool IRAM_ATTR applyDueEvents(uint32_t now)
+{
+    bool applied = false;
+    ControlEvent event;
+    while (peekEvent(event) && (int32_t)(event.frame - now) <= 0)
+    {
+        applyEvent(event);
+        dropEvent(event);
+        applied = true;
+    }
+    return applied;
+}
+
+// Frames from now until the next queued event, at most limit. One that reached the queue already
+// late is due now, and gives 0.
+static int IRAM_ATTR framesToNextEvent(uint32_t now, int limit)
+{
+    ControlEvent event;
+    if (!peekEvent(event))
+        return limit;
+    int32_t until = (int32_t)(event.frame - now);
+    return until <= 0 ? 0 : until < limit ? (int)until : limit;
+}
+
+// Render a block of frames, running the control stage every CONTROL_BLOCK_SIZE frames and on every
+// frame a control event falls on
+void IRAM_ATTR renderBlock(AudioBlock &block, int frames, const float cvValues[])
+{
+    // Settings published since the last block take effect from the next control update, or start
+    // a morph toward them from the settings playing now
+    if (acquireParams(engine.incoming, engine.paramsVersion))
+    {
+        // Keep the control events the UI had not taken in yet when it published
+        ControlEvent event;
+        uint32_t sequence = engine.incoming.eventsTaken;
+        while (appliedEventAfter(sequence, event))
+        {
+            applyEventTo(engine.incoming, event);
+        }
+
+        if (engine.incoming.morphSeconds > 0.0f)
+        {
+            engine.morphRemaining = 1.0f;
+            engine.morphStep = 1.0f / (engine.incoming.morphSeconds * AUDIO_SAMPLE_RATE);
+            engine.morphFrames = 0;
+        }
+        else
+        {
+            engine.params = engine.incoming;
+            engine.morphRemaining = 0.0f;
+        }
+    }
+
+    int n = 0;
+    while (n < frames)
+    {
+        uint32_t now = engine.frameClock + n;
+        bool changed = applyDueEvents(now);
+        if (engine.controlFramesLeft == 0 || changed)
+        {
+            if (engine.morphRemaining > 0.0f && engine.morphFrames > 0)
+                advanceMorph();
+            updateControl(cvValues);
+        }
+
+        int chunk = frames - n < engine.controlFramesLeft ? frames - n : engine.controlFramesLeft;
+        chunk = framesToNextEvent(now, chunk);
+        if (chunk == 0)
+            continue; // An event turned up due since the check above, the next pass applies it
+        renderFrames(block, n, chunk);
+        engine.controlFramesLeft -= chunk;
+        if (engine.morphRemaining > 0.0f)
+            engine.morphFrames += chunk;
+        n += chunk;
+    }
+    engine.frameClock += frames;
+}
+
+uint32_t IRAM_ATTR renderedFrames()
+{
+    return engine.frameClock;
+}
+
+void setPartialLimit(int limit)
+{
+    limit = limit < 0 ? 0 : limit > numPartials ? numPartials : limit;
+    partialCap.store(limit, std::memory_order_relaxed);
+}
+
+int partialLimit()
+{
+    return partialCap.load(std::memory_order_relaxed);
+}
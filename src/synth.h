@@ -0,0 +1,122 @@
+/*
+ * File: synth.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include "audio.h"
+
+// Waveform parameters
+const int numSampleBits = 8;
+const int numSamples = 1 << numSampleBits; // Sine table length, a power of two for phase indexing
+
+// Partials in the additive engine, harmonics 1 to numPartials of the base frequency. The first
+// numWaveOutputs each drive their own MCP4725, the rest only reach the mix buses.
+#ifndef SYNTH_PARTIALS
+#define SYNTH_PARTIALS 32
+#endif
+const int numPartials = SYNTH_PARTIALS;
+const int numWaveOutputs = 7;
+static_assert(numPartials >= numWaveOutputs, "every individual wave output needs a partial");
+
+// Frames between control-rate updates of frequency, amplitude and pan; the audio loop ramps
+// linearly toward each new target across this many frames
+#define CONTROL_BLOCK_SIZE (AUDIO_BLOCK_SIZE < 32 ? AUDIO_BLOCK_SIZE : 32)
+
+// Set to 1 to run the audio-rate stage in integer arithmetic: Q15 samples, 32-bit phase, and
+// amplitude and pan ramps in Q22. The control stage stays in float, it only runs once per block.
+#ifndef SYNTH_FIXED_POINT
+#define SYNTH_FIXED_POINT 0
+#endif
+
+#if SYNTH_FIXED_POINT
+typedef int32_t sample_t; // Q15, the bits above full scale carry the headroom of the mix buses
+#else
+typedef float sample_t;
+#endif
+
+// CV input assignments
+enum CVMode
+{
+    NONE,
+    LIN_FM,
+    EXP_FM,
+    AMPLITUDE,
+    PITCH_1V_OCT
+};
+
+// Base waveform type
+enum WaveformType
+{
+    SINE,
+    SAW,
+    TRIANGLE,
+    PULSE
+};
+
+// One rendered block, stored per output so each bus is a contiguous run of samples
+struct AudioBlock
+{
+    sample_t left[AUDIO_BLOCK_SIZE];
+    sample_t right[AUDIO_BLOCK_SIZE];
+    sample_t stereo[AUDIO_BLOCK_SIZE];
+    sample_t wave[numWaveOutputs][AUDIO_BLOCK_SIZE]; // Individual wave outputs, first partials only
+};
+
+// Quantize a sample to the 8-bit built-in DAC and to the 12-bit MCP4725s, clamped to the code range
+static inline uint8_t toDac8(sample_t sample)
+{
+#if SYNTH_FIXED_POINT
+    int32_t code = (sample + 32768) >> 8;
+#else
+    int32_t code = (int32_t)((sample + 1.0f) * 127.5f);
+#endif
+    return (uint8_t)(code < 0 ? 0 : code > 255 ? 255 : code);
+}
+
+static inline uint16_t toDac12(sample_t sample)
+{
+#if SYNTH_FIXED_POINT
+    int32_t code = (sample + 32768) >> 4;
+#else
+    int32_t code = (int32_t)((sample + 1.0f) * 2047.5f);
+#endif
+    return (uint16_t)(code < 0 ? 0 : code > 4095 ? 4095 : code);
+}
+
+void renderBlock(AudioBlock &block, int frames, const float cvValues[]);
+
+// Frames rendered since boot, wrapping after about a day at 48 kHz; control events are stamped on it
+uint32_t renderedFrames();
+
+// Cap the partials rendered, from any task. Those above the cap fade out over a control block and
+// then cost nothing beyond keeping their phase; numPartials renders them all.
+void setPartialLimit(int limit);
+int partialLimit();
+
+#endif
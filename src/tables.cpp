@@ -0,0 +1,118 @@
+/*
+ * File: tables.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "tables.h"
+#include "platform.h"
+
+// C++11 has no std::index_sequence, so the index packs the tables expand over are built here
+template <int... I>
+struct IndexList
+{
+};
+
+template <int N, int... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...>
+{
+};
+
+template <int... I>
+struct MakeIndexList<0, I...>
+{
+    typedef IndexList<I...> type;
+};
+
+// C++11 constexpr functions are a single return statement, so the series recurse term by term.
+// Twenty terms take both series well past double precision over the ranges used here.
+constexpr double pi = 3.14159265358979323846;
+constexpr double ln2 = 0.69314718055994530942;
+
+constexpr double sinSeries(double x2, double term, double sum, int n)
+{
+    return n > 20 ? sum : sinSeries(x2, -term * x2 / ((2.0 * n) * (2.0 * n + 1.0)), sum + term, n + 1);
+}
+
+constexpr double sinAngle(double x)
+{
+    return sinSeries(x * x, x, 0.0, 1);
+}
+
+// sin(2 pi index / size), with the angle folded into [-pi, pi) where the series converges fastest
+constexpr double sinCycle(int index, int size)
+{
+    return sinAngle(2.0 * pi * (index < size / 2 ? index : index - size) / size);
+}
+
+constexpr double expSeries(double y, double term, double sum, int n)
+{
+    return n > 20 ? sum : expSeries(y, term * y / n, sum + term, n + 1);
+}
+
+// 2^(index / size) for index below size
+constexpr double exp2Fraction(int index, int size)
+{
+    return expSeries(ln2 * index / size, 1.0, 0.0, 1);
+}
+
+constexpr int16_t toQ15(double value)
+{
+    return (int16_t)(value >= 0.0 ? value * 32767.0 + 0.5 : value * 32767.0 - 0.5);
+}
+
+template <int... I>
+constexpr LookupTable<float, sizeof...(I)> makeSineTable(IndexList<I...>)
+{
+    return {{(float)sinCycle(I, sizeof...(I))...}};
+}
+
+template <int... I>
+constexpr LookupTable<int16_t, sizeof...(I)> makeSineTableQ15(IndexList<I...>)
+{
+    return {{toQ15(sinCycle(I, sizeof...(I)))...}};
+}
+
+template <int... I>
+constexpr LookupTable<float, sizeof...(I)> makeExp2Table(IndexList<I...>)
+{
+    return {{(float)exp2Fraction(I, sizeof...(I))...}};
+}
+
+template <int... I>
+constexpr LookupTable<float, sizeof...(I)> makeRampSteps(IndexList<I...>)
+{
+    return {{(float)I...}};
+}
+
+// The sine tables only serve the UI and stay in flash. The audio path reads exp2Table and rampSteps
+// every control block, so they are copied to internal DRAM at boot and never miss the flash cache.
+constexpr LookupTable<float, numSamples> sineTable = makeSineTable(MakeIndexList<numSamples>::type());
+constexpr LookupTable<int16_t, numSamples> sineTableQ15 = makeSineTableQ15(MakeIndexList<numSamples>::type());
+constexpr LookupTable<float, EXP2_TABLE_SIZE> exp2Table DRAM_ATTR = makeExp2Table(MakeIndexList<EXP2_TABLE_SIZE>::type());
+constexpr LookupTable<float, CONTROL_BLOCK_SIZE> rampSteps DRAM_ATTR = makeRampSteps(MakeIndexList<CONTROL_BLOCK_SIZE>::type());
+
+static_assert(sineTableQ15[numSamples / 4] == 32767 && sineTableQ15[3 * numSamples / 4] == -32767,
+              "sine table peaks must land on full scale");
+static_assert(exp2Table[0] == 1.0f, "exp2 table must start on unity");
@@ -0,0 +1,54 @@
+/*
+ * File: tables.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef TABLES_H
+#define TABLES_H
+
+#include <stdint.h>
+#include "synth.h"
+#include "pitch.h"
+
+// A lookup table computed by the compiler, the ESP32 maps constant data straight out of flash
+template <typename T, int N>
+struct LookupTable
+{
+    T values[N];
+
+    constexpr T operator[](int index) const { return values[index]; }
+};
+
+// Sine wave table, one full cycle
+extern const LookupTable<float, numSamples> sineTable;
+extern const LookupTable<int16_t, numSamples> sineTableQ15;
+
+// 2^(k / EXP2_TABLE_SIZE) across one octave
+extern const LookupTable<float, EXP2_TABLE_SIZE> exp2Table;
+
+// 0, 1, 2, ... for building ramps with the block kernels
+extern const LookupTable<float, CONTROL_BLOCK_SIZE> rampSteps;
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * File: tuning.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "tuning.h"
+#include "pitch.h"
+#include "platform.h"
+
+// Runs once per scale change, from the control stage when a new scale reaches the engine
+void IRAM_ATTR selectTuning(Tuning &tuning, int scale)
+{
+    const Scale &source = scales[scale >= 0 && scale < scaleCount ? scale : SCALE_HARMONIC];
+    tuning.degreeCount = source.degreeCount;
+    tuning.period = source.period;
+    for (int d = 0; d < source.degreeCount; ++d)
+    {
+        tuning.degrees[d] = source.degrees[d];
+        tuning.factors[d] = fastExp2(source.degrees[d]);
+    }
+    tuning.degrees[source.degreeCount] = source.period;
+    tuning.factors[source.degreeCount] = fastExp2(source.period);
+}
+
+// 2^(periods * period), free within the tonic's own period
+static inline float IRAM_ATTR periodFactor(const Tuning &tuning, int periods)
+{
+    return periods == 0 ? 1.0f : fastExp2(periods * tuning.period);
+}
+
+float IRAM_ATTR degreeFactor(const Tuning &tuning, int n)
+{
+    int periods = n / tuning.degreeCount;
+    int degree = n - periods * tuning.degreeCount;
+    return tuning.factors[degree] * periodFactor(tuning, periods);
+}
+
+float IRAM_ATTR quantizePitch(const Tuning &tuning, float octaves)
+{
+    int periods = floorToInt(octaves / tuning.period);
+    float within = octaves - periods * tuning.period;
+
+    // Bisect for the degrees either side, the closing entry makes the top of the period a candidate
+    int low = 0;
+    int high = tuning.degreeCount;
+    while (high - low > 1)
+    {
+        int middle = (low + high) / 2;
+        if (tuning.degrees[middle] <= within)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    int nearest = within - tuning.degrees[low] <= tuning.degrees[high] - within ? low : high;
+    return tuning.factors[nearest] * periodFactor(tuning, periods);
+}
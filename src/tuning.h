@@ -0,0 +1,69 @@
+/*
+ * File: tuning.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdint.h>
+#include "synth.h"
+
+// Scales come from Scala .scl files in resources/scales, compiled into the DRAM tables of scales.cpp
+// by host/scala_tables.py. Entry SCALE_HARMONIC keeps the partials on the harmonic series and leaves
+// CV pitch unquantized.
+#define SCALE_HARMONIC 0
+#define SCALE_MAX_DEGREES 64
+
+struct Scale
+{
+    const char *name;
+    int degreeCount;      // Degrees per period, 0 for the harmonic series
+    float period;         // Octaves after which the degrees repeat, 1.0 for an octave-repeating scale
+    const float *degrees; // In octaves above the tonic, ascending from 0 and below the period
+};
+
+extern const Scale scales[];
+extern const int scaleCount;
+
+// The scale the engine plays, copied out of the tables when it changes: degrees for the quantizer's
+// search, and the frequency factor of each degree so a snapped pitch never goes through exp2
+struct Tuning
+{
+    int degreeCount;
+    float period;
+    float degrees[SCALE_MAX_DEGREES + 1]; // Closed by the period, the next period's tonic
+    float factors[SCALE_MAX_DEGREES + 1];
+};
+
+void selectTuning(Tuning &tuning, int scale);
+
+// Frequency factor of the n-th degree above the tonic, counting on through the periods
+float degreeFactor(const Tuning &tuning, int n);
+
+// Snap a pitch in octaves above the tonic to the nearest degree and return its frequency factor
+float quantizePitch(const Tuning &tuning, float octaves);
+
+#endif
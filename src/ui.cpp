@@ -0,0 +1,490 @@
+/*
+ * File: ui.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "ui.h"
+#include "display.h"
+#include "params.h"
+#include "capture.h"
+#include "profile.h"
+#include "input.h"
+#include "tuning.h"
+#include "governor.h"
+#include "analyzer.h"
+#include "events.h"
+#include <Arduino.h>
+
+extern float harmonicAmplitudes[];
+extern float harmonicPanning[];
+extern float baseFrequency;
+extern int baseFrequencyIndex;
+extern int harmonicIndex;
+extern int menuIndex;
+extern int scaleIndex;
+extern MenuMode currentMenu;
+extern bool inMenu;
+extern bool inPopupMenu;
+extern float modulationMatrix[numPartials][numPartials];
+extern CVMode cvAssignments[];
+extern WaveformType currentWaveform;
+extern bool xySwapped;
+extern float xyBiasX;
+extern float xyBiasY;
+extern bool xyPersistence;
+
+static TaskHandle_t uiTaskHandle = NULL;
+static bool editing = false; // Turning changes the value under the cursor instead of moving it
+static int popupIndex = 0;
+static bool redrawNeeded = true;
+static bool splashing = true;
+static TickType_t splashEnd = 0;
+
+static int wrapIndex(int value, int count)
+{
+    return ((value % count) + count) % count;
+}
+
+static float clampValue(float value, float low, float high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+// Take over what MIDI or the serial protocol changed once the engine plays it, so the settings
+// shown and published keep it. Returns true when anything changed.
+static bool mirrorControlChanges()
+{
+    bool any = false;
+    ControlEvent change;
+    while (nextAppliedEvent(change))
+    {
+        any = true;
+        switch (change.type)
+        {
+        case EVENT_FREQUENCY:
+            baseFrequency = change.value;
+            break;
+        case EVENT_AMPLITUDE:
+            harmonicAmplitudes[change.source] = change.value;
+            break;
+        case EVENT_MATRIX:
+            modulationMatrix[change.source][change.target] = change.value;
+            break;
+        default:
+            break;
+        }
+    }
+    return any;
+}
+
+// Hand the current settings to the audio engine as one snapshot
+void publishSettings(float morphSeconds)
+{
+    static SynthParams params; // Sized by the partial count, kept off the caller's stack
+    memcpy(params.harmonicAmplitudes, harmonicAmplitudes, sizeof(params.harmonicAmplitudes));
+    memcpy(params.harmonicPanning, harmonicPanning, sizeof(params.harmonicPanning));
+    memcpy(params.modulationMatrix, modulationMatrix, sizeof(params.modulationMatrix));
+    memcpy(params.cvAssignments, cvAssignments, sizeof(params.cvAssignments));
+    params.baseFrequency = baseFrequency;
+    params.waveform = currentWaveform;
+    params.scale = scaleIndex;
+    params.morphSeconds = morphSeconds;
+    params.eventsTaken = appliedEventsTaken(); // The engine keeps any events applied since on top
+    publishParams(params);
+}
+
+// Number of cursor positions on a page, zero for pages that only display
+static int cursorCount(MenuMode menu)
+{
+    switch (menu)
+    {
+    case SCALE_MENU:
+        return scaleCount;
+    case FREQUENCY_MENU:
+    case CV_MENU:
+    case WAVEFORM_MENU:
+        return 4;
+    case HARMONIC_MENU:
+    case MODULATION_MENU:
+    case PANNING_MENU:
+    case AMPLITUDE_MENU:
+        return numPartials;
+    case XY_DISPLAY:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// The harmonic editor pages move the selected harmonic, every other page its own menu cursor
+static int &cursorFor(MenuMode menu)
+{
+    return (menu == HARMONIC_MENU || menu == AMPLITUDE_MENU) ? harmonicIndex : menuIndex;
+}
+
+// Apply encoder steps to the value under the cursor
+static void adjustValue(int steps)
+{
+    switch (currentMenu)
+    {
+    case HARMONIC_MENU:
+    case AMPLITUDE_MENU:
+        harmonicAmplitudes[harmonicIndex] = clampValue(harmonicAmplitudes[harmonicIndex] + steps * 0.1f, 0.0f, 1.0f);
+        break;
+    case MODULATION_MENU:
+        modulationMatrix[menuIndex][harmonicIndex] = clampValue(modulationMatrix[menuIndex][harmonicIndex] + steps * 1.0f, -100.0f, 100.0f);
+        break;
+    case PANNING_MENU:
+        harmonicPanning[menuIndex] = clampValue(harmonicPanning[menuIndex] + steps * 0.1f, 0.0f, 1.0f);
+        break;
+    case CV_MENU:
+        cvAssignments[menuIndex] = (CVMode)wrapIndex(cvAssignments[menuIndex] + steps, PITCH_1V_OCT + 1);
+        break;
+    case XY_DISPLAY:
+        if (menuIndex == 0 && (steps & 1))
+            xySwapped = !xySwapped;
+        else if (menuIndex == 1)
+            xyBiasX = clampValue(xyBiasX + steps * 0.1f, -1.0f, 1.0f);
+        else if (menuIndex == 2)
+            xyBiasY = clampValue(xyBiasY + steps * 0.1f, -1.0f, 1.0f);
+        else if (menuIndex == 3 && (steps & 1))
+            xyPersistence = !xyPersistence;
+        return; // Display-only settings, nothing to publish
+    default:
+        return;
+    }
+    publishSettings();
+}
+
+// Outside a page turning steps through the pages, inside it moves the cursor or edits a value
+static void handleTurn(int steps)
+{
+    if (inPopupMenu)
+    {
+        popupIndex = wrapIndex(popupIndex + steps, 7);
+    }
+    else if (!inMenu)
+    {
+        currentMenu = (MenuMode)wrapIndex(currentMenu + steps, DEFAULT_VIEW + 1);
+    }
+    else if (editing)
+    {
+        adjustValue(steps);
+    }
+    else
+    {
+        int &cursor = cursorFor(currentMenu);
+        cursor = wrapIndex(cursor + steps, cursorCount(currentMenu));
+    }
+}
+
+// A short press enters a page, picks a list entry or toggles editing of the value under the cursor
+static void handlePress()
+{
+    if (inPopupMenu)
+    {
+        if (!handlePopupSelection(popupIndex))
+            inPopupMenu = false;
+        return;
+    }
+
+    if (!inMenu)
+    {
+        if (cursorCount(currentMenu) == 0)
+            return;
+        inMenu = true;
+        editing = false;
+
+        // List pages open on the entry currently in use
+        if (currentMenu == SCALE_MENU)
+            menuIndex = scaleIndex;
+        else if (currentMenu == FREQUENCY_MENU)
+            menuIndex = baseFrequencyIndex;
+        else if (currentMenu == WAVEFORM_MENU)
+            menuIndex = currentWaveform;
+        else
+            menuIndex = 0;
+        return;
+    }
+
+    switch (currentMenu)
+    {
+    case SCALE_MENU:
+        scaleIndex = menuIndex;
+        publishSettings();
+        inMenu = false;
+        break;
+    case FREQUENCY_MENU:
+        baseFrequencyIndex = menuIndex;
+        baseFrequency = baseFrequencies[menuIndex];
+        publishSettings();
+        inMenu = false;
+        break;
+    case WAVEFORM_MENU:
+        currentWaveform = (WaveformType)menuIndex;
+        publishSettings();
+        inMenu = false;
+        break;
+    default:
+        editing = !editing;
+        break;
+    }
+}
+
+// A long press leaves the current page, or opens and closes the popup menu from the top level
+static void handleLongPress()
+{
+    if (inMenu)
+    {
+        inMenu = false;
+        editing = false;
+    }
+    else
+    {
+        inPopupMenu = !inPopupMenu;
+        popupIndex = 0;
+    }
+}
+
+// Button state, debounced from the timestamped edges: once they have been quiet for
+// BUTTON_DEBOUNCE_MS the pin is read and the state changes as of the first edge of the burst
+static bool buttonPressed = false;
+static bool longPressHandled = false;
+static bool buttonSettling = false;
+static uint32_t buttonBurstAt = 0;
+static uint32_t buttonEdgeAt = 0;
+static uint32_t buttonChangedAt = 0;
+
+static void noteButtonEdge(uint32_t time)
+{
+    if (!buttonSettling)
+    {
+        buttonSettling = true;
+        buttonBurstAt = time;
+    }
+    buttonEdgeAt = time;
+}
+
+// Settle the button and tell short presses from long ones
+static void updateButton(uint32_t now)
+{
+    if (buttonSettling && now - buttonEdgeAt >= BUTTON_DEBOUNCE_MS * 1000u)
+    {
+        buttonSettling = false;
+        bool down = buttonDown();
+        if (down != buttonPressed)
+        {
+            buttonPressed = down;
+            buttonChangedAt = buttonBurstAt;
+            if (!buttonPressed && !longPressHandled)
+            {
+                handlePress();
+            }
+            longPressHandled = false;
+            redrawNeeded = true;
+        }
+    }
+    else if (buttonPressed && !longPressHandled && now - buttonChangedAt >= BUTTON_LONG_PRESS_MS * 1000u)
+    {
+        longPressHandled = true;
+        handleLongPress();
+        redrawNeeded = true;
+    }
+}
+
+// Ticks until a deadline elapsedUs into a span of spanUs, rounded up so the wait never ends early
+static uint32_t ticksUntil(uint32_t elapsedUs, uint32_t spanUs)
+{
+    const uint32_t tickUs = portTICK_PERIOD_MS * 1000u;
+    return elapsedUs >= spanUs ? 0 : (spanUs - elapsedUs + tickUs - 1) / tickUs;
+}
+
+// The particle and ripple views cost the most to draw and tell the least, the governor pauses them first
+static bool isPausedVisual()
+{
+    return governorVisualsPaused() && (currentMenu == PARTICLE_DISPLAY || currentMenu == RIPPLE_DISPLAY);
+}
+
+// The visualizers move on their own and redraw every frame, the other pages only when something changed
+static bool isAnimated()
+{
+    return !inMenu && !inPopupMenu && !isPausedVisual() &&
+           (currentMenu == PARTICLE_DISPLAY || currentMenu == XY_DISPLAY ||
+            currentMenu == RIPPLE_DISPLAY || currentMenu == OSCILLOSCOPE_DISPLAY ||
+            currentMenu == SPECTRUM_DISPLAY);
+}
+
+static void drawCurrentView()
+{
+    if (inPopupMenu)
+    {
+        drawPopupMenu(popupIndex);
+        return;
+    }
+    if (isPausedVisual())
+    {
+        drawVisualsPaused();
+        return;
+    }
+
+    switch (currentMenu)
+    {
+    case DEFAULT_VIEW:
+    case HARMONIC_MENU:
+        drawWaveforms();
+        break;
+    case AMPLITUDE_MENU:
+        drawAmplitudeBars();
+        break;
+    case PARTICLE_DISPLAY:
+        drawParticles();
+        break;
+    case XY_DISPLAY:
+        if (inMenu)
+            drawMenu(); // Scope settings
+        else
+            drawXYOscilloscope();
+        break;
+    case RIPPLE_DISPLAY:
+        drawRippleEffect();
+        break;
+    case OSCILLOSCOPE_DISPLAY:
+        drawWaveformOscilloscope();
+        break;
+    case SPECTRUM_DISPLAY:
+        drawSpectrum();
+        break;
+    default:
+        drawMenu();
+        break;
+    }
+}
+
+// The earliest of the next frame due, the button settling, a long press and the idle poll
+static uint32_t ticksToNextDeadline(TickType_t lastFrame, TickType_t framePeriod)
+{
+    uint32_t wait = pdMS_TO_TICKS(UI_IDLE_POLL_MS);
+    uint32_t deadline;
+
+    if (splashing)
+    {
+        TickType_t now = xTaskGetTickCount();
+        deadline = (int32_t)(splashEnd - now) > 0 ? splashEnd - now : 0;
+        wait = deadline < wait ? deadline : wait;
+    }
+    else if (redrawNeeded || isAnimated())
+    {
+        TickType_t elapsed = xTaskGetTickCount() - lastFrame;
+        deadline = elapsed >= framePeriod ? 0 : framePeriod - elapsed;
+        wait = deadline < wait ? deadline : wait;
+    }
+
+    uint32_t now = inputTime();
+    if (buttonSettling)
+    {
+        deadline = ticksUntil(now - buttonEdgeAt, BUTTON_DEBOUNCE_MS * 1000u);
+        wait = deadline < wait ? deadline : wait;
+    }
+    else if (buttonPressed && !longPressHandled)
+    {
+        deadline = ticksUntil(now - buttonChangedAt, BUTTON_LONG_PRESS_MS * 1000u);
+        wait = deadline < wait ? deadline : wait;
+    }
+    return wait;
+}
+
+// Sleep until input arrives or something falls due, then redraw within the frame budget. Input is
+// decoded and stamped in interrupts, so a slow frame delays its handling but never loses it.
+// Drawing only fills the framebuffer, the transfer happens in the display flush task below this one.
+static void uiTask(void *parameter)
+{
+    TickType_t framePeriod = pdMS_TO_TICKS(1000 / UI_FRAME_RATE);
+
+    // Audio is already running, the input interrupts and the panel come up here, away from its core
+    initInput();
+    initDisplay();
+    splashEnd = xTaskGetTickCount() + pdMS_TO_TICKS(UI_SPLASH_MS);
+    TickType_t lastFrame = xTaskGetTickCount() - framePeriod;
+
+    for (;;)
+    {
+        // Take everything queued in one go, so a fast spin costs one redraw
+        InputEvent event;
+        int steps = 0;
+        bool received = nextInputEvent(event, ticksToNextDeadline(lastFrame, framePeriod));
+        bool anyInput = received;
+        while (received)
+        {
+            if (event.type == INPUT_TURN)
+                steps += event.value;
+            else
+                noteButtonEdge(event.time);
+            received = nextInputEvent(event, 0);
+        }
+
+        if (steps != 0)
+        {
+            handleTurn(steps);
+            redrawNeeded = true;
+        }
+
+        updateButton(inputTime());
+        pollCapture(); // Keep the scope history current whichever view is up
+
+        if (mirrorControlChanges())
+            redrawNeeded = true;
+
+        // Give up display work first when audio runs short of headroom
+        if (pollGovernor())
+        {
+            framePeriod = pdMS_TO_TICKS(1000 / governorFrameRate());
+            redrawNeeded = true;
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if (splashing && (anyInput || (int32_t)(now - splashEnd) >= 0))
+        {
+            splashing = false;
+            redrawNeeded = true;
+        }
+
+        if (!splashing && (redrawNeeded || isAnimated()) && now - lastFrame >= framePeriod)
+        {
+            uint32_t startCycles = profileStart();
+            drawCurrentView();
+            profileEnd(PROFILE_DRAW, startCycles);
+            redrawNeeded = false;
+            lastFrame = now;
+        }
+    }
+}
+
+void initUI()
+{
+    initEffects();
+    initAnalyzer();
+
+    xTaskCreatePinnedToCore(uiTask, "ui", 8192, NULL, UI_TASK_PRIORITY, &uiTaskHandle, 0);
+}
@@ -0,0 +1,44 @@
+/*
+ * File: ui.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef UI_H
+#define UI_H
+
+// The UI task sleeps until an input event or its next deadline and redraws the display at most
+// UI_FRAME_RATE times a second
+#define UI_FRAME_RATE 30
+#define UI_IDLE_POLL_MS 50 // Longest sleep, keeps the scope history and external control changes current
+#define UI_SPLASH_MS 3000  // The splash stays up this long, or until the first input
+#define UI_TASK_PRIORITY (tskIDLE_PRIORITY + 2) // Below the CV sampler, above the display flush
+
+#define BUTTON_DEBOUNCE_MS 20
+#define BUTTON_LONG_PRESS_MS 600
+
+void initUI();
+void publishSettings(float morphSeconds = 0.0f); // Morphs from the playing settings when morphSeconds > 0
+
+#endif
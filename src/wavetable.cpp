@@ -0,0 +1,137 @@
+/*
+ * File: wavetable.cpp
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#include "wavetable.h"
+#include <math.h>
+
+// Each mip level covers phase increments in [2^(level + LOWEST_OCTAVE), 2^(level + LOWEST_OCTAVE + 1)),
+// the last level ends just below Nyquist at 2^31
+#define LOWEST_OCTAVE (31 - WAVETABLE_LEVELS)
+
+// Partial sums of the saw series rise toward the Wilbraham-Gibbs constant, those of the square fall
+// toward it from 4/pi, the fundamental alone, so the sparsest pulse level sets the pulse scale
+#define GIBBS_PEAK 1.17898f
+#define SQUARE_PEAK 1.27324f
+
+static const float pi = (float)M_PI;
+
+// SAW, TRIANGLE and PULSE tables. Sine partials need none, they run a recurrence, see synth.cpp
+static int16_t wavetables[3][WAVETABLE_LEVELS][WAVETABLE_SIZE];
+
+// Highest harmonic that stays below Nyquist across the whole octave of a level
+static int maxHarmonic(int level)
+{
+    int harmonics = 1 << (WAVETABLE_LEVELS - 1 - level);
+    return harmonics < WAVETABLE_SIZE / 2 ? harmonics : WAVETABLE_SIZE / 2 - 1;
+}
+
+// Fourier coefficient of harmonic h, toward a sine (or cosine for the triangle) term at unit amplitude
+static float harmonicCoefficient(WaveformType waveform, int h)
+{
+    switch (waveform)
+    {
+    case SAW:
+        return -2.0f / (pi * h); // Rising ramp from -1 to 1
+    case TRIANGLE:
+        return (h & 1) ? 8.0f / (pi * pi * h * h) : 0.0f;
+    case PULSE:
+        return (h & 1) ? 4.0f / (pi * h) : 0.0f;
+    case SINE:
+    default:
+        return h == 1 ? 1.0f : 0.0f;
+    }
+}
+
+// Build every level additively, starting from the sparsest so each level only adds the harmonics
+// the next octave up had to drop
+void initWavetables()
+{
+    float *reference = new float[WAVETABLE_SIZE];
+    float *accumulator = new float[WAVETABLE_SIZE];
+
+    for (int n = 0; n < WAVETABLE_SIZE; ++n)
+    {
+        reference[n] = sinf(2.0f * pi * n / WAVETABLE_SIZE);
+    }
+
+    for (int w = 0; w < 3; ++w)
+    {
+        WaveformType waveform = (WaveformType)(SAW + w);
+        int phaseOffset = waveform == TRIANGLE ? WAVETABLE_SIZE / 4 : 0; // Cosine terms
+        float scale = waveform == TRIANGLE ? 32767.0f : 32767.0f / (waveform == PULSE ? SQUARE_PEAK : GIBBS_PEAK);
+        int harmonics = 0;
+
+        for (int n = 0; n < WAVETABLE_SIZE; ++n)
+        {
+            accumulator[n] = 0.0f;
+        }
+
+        for (int level = WAVETABLE_LEVELS - 1; level >= 0; --level)
+        {
+            for (int h = harmonics + 1; h <= maxHarmonic(level); ++h)
+            {
+                float coefficient = harmonicCoefficient(waveform, h);
+                if (coefficient == 0.0f)
+                    continue;
+
+                // h * n stays an exact table index, so no trig is needed per harmonic
+                for (int n = 0; n < WAVETABLE_SIZE; ++n)
+                {
+                    accumulator[n] += coefficient * reference[(h * n + phaseOffset) & (WAVETABLE_SIZE - 1)];
+                }
+            }
+            harmonics = maxHarmonic(level);
+
+            for (int n = 0; n < WAVETABLE_SIZE; ++n)
+            {
+                long value = lrintf(accumulator[n] * scale);
+                wavetables[w][level][n] = (int16_t)(value > 32767 ? 32767 : (value < -32767 ? -32767 : value));
+            }
+        }
+    }
+
+    delete[] accumulator;
+    delete[] reference;
+}
+
+// Pick the mip level from the phase increment
+int IRAM_ATTR wavetableLevel(uint32_t increment)
+{
+    // Negative frequencies run the phase backwards, only the magnitude matters
+    if ((int32_t)increment < 0)
+        increment = 0u - increment;
+    if (increment >= (1u << 31))
+        return -1;
+    if (increment < (1u << LOWEST_OCTAVE))
+        return 0;
+    return (31 - __builtin_clz(increment)) - LOWEST_OCTAVE;
+}
+
+const int16_t *IRAM_ATTR wavetable(WaveformType waveform, int level)
+{
+    return wavetables[waveform - SAW][level];
+}
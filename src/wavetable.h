@@ -0,0 +1,66 @@
+/*
+ * File: wavetable.h
+ *
+ * Author: Tyler Reckart (tyler.reckart@gmail.com)
+ * Copyright 2024
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * See http://creativecommons.org/licenses/MIT/ for more information.
+ */
+
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+#include <stdint.h>
+#include "synth.h"
+#include "platform.h"
+
+// Band-limited wavetables, one mip level per octave of phase increment
+#define WAVETABLE_BITS 10
+#define WAVETABLE_SIZE (1 << WAVETABLE_BITS)
+#define WAVETABLE_LEVELS 10 // Level 0 holds WAVETABLE_SIZE / 2 - 1 harmonics, the last one a single sine
+
+void initWavetables();
+int wavetableLevel(uint32_t increment); // Mip level for a phase increment, -1 once the fundamental passes Nyquist
+const int16_t *wavetable(WaveformType waveform, int level);
+
+// Read a table at a phase, interpolating linearly on the bits below the table index
+static inline float IRAM_ATTR readWavetable(const int16_t *table, uint32_t phase)
+{
+    const int fractionBits = 32 - WAVETABLE_BITS;
+    uint32_t index = phase >> fractionBits;
+    float fraction = (float)(phase & ((1u << fractionBits) - 1)) * (1.0f / (1u << fractionBits));
+    float a = table[index];
+    float b = table[(index + 1) & (WAVETABLE_SIZE - 1)];
+    return (a + (b - a) * fraction) * (1.0f / 32767.0f);
+}
+
+// Q15 read, interpolating on 15 fraction bits; the widest step between neighbours (a full-scale
+// edge) times the fraction still fits 32 bits
+static inline int32_t IRAM_ATTR readWavetableQ15(const int16_t *table, uint32_t phase)
+{
+    uint32_t index = phase >> (32 - WAVETABLE_BITS);
+    int32_t fraction = (int32_t)(phase >> (32 - WAVETABLE_BITS - 15)) & 0x7FFF;
+    int32_t a = table[index];
+    int32_t b = table[(index + 1) & (WAVETABLE_SIZE - 1)];
+    return a + (((b - a) * fraction) >> 15);
+}
+
+#endif